@@ -0,0 +1,240 @@
+#pragma once
+
+#include <bit>
+#include <compare>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+
+#include "playing_cards.h"
+
+namespace cards
+{
+// A card packed into one byte as (face value - 1) * 4 + suit.
+// Only six bits are used, and comparing the bytes gives the same aces low order as Card
+class PackedCard
+{
+public:
+  PackedCard () = default;
+  explicit PackedCard (const Card &card)
+      : bits_ (static_cast<std::uint8_t> ((card.value ().value () - 1) * 4 + static_cast<int> (card.suit ())))
+  {
+  }
+
+  // index runs from 0 (Ace of Hearts) to 51 (King of Spades)
+  static constexpr PackedCard
+  from_index (int index)
+  {
+    PackedCard card;
+    card.bits_ = static_cast<std::uint8_t> (index);
+    return card;
+  }
+  constexpr int
+  index () const
+  {
+    return bits_;
+  }
+  constexpr int
+  face_value () const
+  {
+    return bits_ / 4 + 1;
+  }
+  constexpr Suit
+  suit () const
+  {
+    return static_cast<Suit> (bits_ % 4);
+  }
+  Card
+  to_card () const
+  {
+    return Card{ FaceValue (face_value ()), suit () };
+  }
+
+  auto operator<=> (const PackedCard &) const = default; // aces low, like Card
+private:
+  std::uint8_t bits_{};
+};
+
+static_assert (sizeof (PackedCard) == 1);
+
+inline bool
+is_guess_correct (char guess, PackedCard current, PackedCard next)
+{
+  return (guess == 'h' && next > current) || (guess == 'l' && next < current);
+}
+
+// A hand or deck held as a 64-bit mask with bit PackedCard::index () set for each card present
+class CardSet
+{
+public:
+  // Walks the cards from lowest to highest by clearing the lowest set bit
+  class iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = PackedCard;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = PackedCard;
+
+    iterator () = default;
+    explicit iterator (std::uint64_t bits) : bits_ (bits) {}
+    PackedCard
+    operator* () const
+    {
+      return PackedCard::from_index (std::countr_zero (bits_));
+    }
+    iterator &
+    operator++ ()
+    {
+      bits_ &= bits_ - 1;
+      return *this;
+    }
+    iterator
+    operator++ (int)
+    {
+      iterator before = *this;
+      ++*this;
+      return before;
+    }
+    bool operator== (const iterator &) const = default;
+
+  private:
+    std::uint64_t bits_{};
+  };
+
+  static constexpr std::uint64_t deck_mask = (std::uint64_t{ 1 } << 52) - 1;
+
+  CardSet () = default;
+  explicit CardSet (std::uint64_t mask) : mask_ (mask & deck_mask) {}
+  template <std::ranges::range T> explicit CardSet (const T &cards)
+  {
+    for (const auto &card : cards)
+      {
+        insert (card);
+      }
+  }
+  static CardSet
+  full_deck ()
+  {
+    return CardSet{ deck_mask };
+  }
+
+  void
+  insert (PackedCard card)
+  {
+    mask_ |= bit (card);
+  }
+  void
+  insert (const Card &card)
+  {
+    insert (PackedCard (card));
+  }
+  void
+  erase (PackedCard card)
+  {
+    mask_ &= ~bit (card);
+  }
+  bool
+  contains (PackedCard card) const
+  {
+    return (mask_ & bit (card)) != 0;
+  }
+  int
+  size () const
+  {
+    return std::popcount (mask_);
+  }
+  bool
+  empty () const
+  {
+    return mask_ == 0;
+  }
+  std::uint64_t
+  mask () const
+  {
+    return mask_;
+  }
+
+  // Precondition: not empty
+  PackedCard
+  lowest () const
+  {
+    return PackedCard::from_index (std::countr_zero (mask_));
+  }
+  PackedCard
+  pop_lowest ()
+  {
+    PackedCard card = lowest ();
+    mask_ &= mask_ - 1;
+    return card;
+  }
+
+  // The cards in this set ordered strictly below or above the given card
+  CardSet
+  below (PackedCard card) const
+  {
+    return CardSet{ mask_ & (bit (card) - 1) };
+  }
+  CardSet
+  above (PackedCard card) const
+  {
+    return CardSet{ mask_ & ~((bit (card) << 1) - 1) };
+  }
+
+  iterator
+  begin () const
+  {
+    return iterator{ mask_ };
+  }
+  iterator
+  end () const
+  {
+    return iterator{};
+  }
+
+  CardSet &
+  operator|= (CardSet other)
+  {
+    mask_ |= other.mask_;
+    return *this;
+  }
+  CardSet &
+  operator&= (CardSet other)
+  {
+    mask_ &= other.mask_;
+    return *this;
+  }
+  CardSet &
+  operator-= (CardSet other)
+  {
+    mask_ &= ~other.mask_;
+    return *this;
+  }
+  friend CardSet
+  operator| (CardSet lhs, CardSet rhs)
+  {
+    return lhs |= rhs;
+  }
+  friend CardSet
+  operator& (CardSet lhs, CardSet rhs)
+  {
+    return lhs &= rhs;
+  }
+  friend CardSet
+  operator- (CardSet lhs, CardSet rhs)
+  {
+    return lhs -= rhs;
+  }
+  bool operator== (const CardSet &) const = default;
+
+private:
+  static std::uint64_t
+  bit (PackedCard card)
+  {
+    return std::uint64_t{ 1 } << card.index ();
+  }
+
+  std::uint64_t mask_{};
+};
+}
@@ -1,9 +1,22 @@
+#include <algorithm>
 #include <iostream>
 
+#include "card_set.h"
 #include "playing_cards.h"
+#include "poker.h"
+#include "shoe.h"
+#include "shuffle_log.h"
+#include "shuffler.h"
+#include "simulator.h"
+#include "solver.h"
+#include "table_service.h"
 
 #include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
 #include <set>
+#include <stdexcept>
 void
 check_properties ()
 {
@@ -38,6 +51,236 @@ check_properties ()
   assert (is_guess_correct ('l', std::variant<Card, Joker> (Card{ FaceValue (6), Suit::Clubs }),
                             std::variant<Card, Joker> (Joker{})));
   assert (is_guess_correct ('l', std::variant<Card, Joker> (Joker{}), std::variant<Card, Joker> (Joker{})));
+
+  // Packed cards keep the same order as Card
+  static_assert (sizeof (PackedCard) == 1);
+  for (const auto &card : cards)
+    {
+      assert (PackedCard (card).to_card () == card);
+      for (const auto &other : cards)
+        {
+          assert ((PackedCard (card) <=> PackedCard (other)) == (card <=> other));
+        }
+    }
+
+  CardSet deck (cards);
+  assert (deck.size () == 52);
+  assert (deck == CardSet::full_deck ());
+  assert (std::ranges::equal (deck, as_set, {}, &PackedCard::to_card));
+  PackedCard five_of_clubs (Card{ FaceValue (5), Suit::Clubs });
+  assert (deck.below (five_of_clubs).size () == 18);
+  assert (deck.above (five_of_clubs).size () == 33);
+  deck.erase (five_of_clubs);
+  assert (!deck.contains (five_of_clubs));
+  assert (deck.pop_lowest () == PackedCard (Card{ FaceValue (1), Suit::Hearts }));
+  assert (deck.size () == 50);
+
+  // The same seed deals the same decks, and every deal is a permutation
+  Shuffler shuffler (42);
+  Shuffler same_seed (42);
+  auto     decks = shuffler.deal (cards, 100);
+  assert (decks == same_seed.deal (cards, 100));
+  assert (decks[0] != decks[1]);
+  for (const auto &dealt : decks)
+    {
+      assert (CardSet (dealt) == CardSet::full_deck ());
+    }
+  auto extended = create_extended_deck ();
+  shuffler.shuffle (extended);
+  assert (std::ranges::count_if (extended, [] (const auto &card) { return std::holds_alternative<Joker> (card); })
+          == 2);
+  for (int i = 0; i < 1000; ++i)
+    {
+      assert (shuffler.bounded (52) < 52);
+    }
+
+  // Headless games: always guessing higher gets through a deck in order
+  std::array<PackedCard, 52> in_order;
+  std::ranges::copy (CardSet::full_deck (), in_order.begin ());
+  assert (play_higher_lower (always_higher, in_order) == 51);
+  assert (play_higher_lower (guess_by_midpoint, in_order) == 26);
+  std::array<PackedCard, 54> jokers_first{ PackedCard::from_index (52), PackedCard::from_index (53) };
+  std::ranges::copy (in_order, jokers_first.begin () + 2);
+  assert (play_higher_lower_with_jokers (always_higher, jokers_first) == 53);
+  std::ranges::reverse (jokers_first);
+  assert (play_higher_lower_with_jokers (count_cards, jokers_first) == 53);
+
+  SimulationOptions options{ .games = 20'000, .threads = 1, .seed = 7 };
+  auto              one_thread = simulate (count_cards, options);
+  options.threads              = 3;
+  auto three_threads           = simulate (count_cards, options);
+  assert (one_thread.games () == 20'000);
+  assert (one_thread.scores == three_threads.scores);
+  assert (one_thread.mean () > simulate (always_higher, options).mean ());
+
+  // The exact solver agrees with hand worked positions, and the simulation of the same play
+  HigherLowerSolver solver;
+  assert (solver.expected_score (0, 0) == 0.0);
+  assert (solver.expected_score (0, 1) == 1.0);
+  assert (solver.best_guess (0, 1) == 'h');
+  assert (solver.best_guess (40, 3) == 'l');
+  assert (solver.expected_score (1, 1) == 1.0);
+  HigherLowerSolver solver_with_jokers (2, 3);
+  assert (solver_with_jokers.expected_score_after_joker (0, 1) == 1.0);
+  assert (solver_with_jokers.expected_score () > solver.expected_score ());
+  options.games = 200'000;
+  assert (std::abs (simulate (play_optimally, options).mean () - solver.expected_score ()) < 0.05);
+
+  // Table driven poker hands agree with the naive evaluator
+  HandEvaluator evaluator;
+  auto          pack = [] (const auto &hand) {
+    std::array<PackedCard, std::tuple_size_v<std::remove_cvref_t<decltype (hand)> > > packed;
+    std::ranges::transform (hand, packed.begin (), [] (const Card &card) { return PackedCard (card); });
+    return packed;
+  };
+  const std::array<Card, 5> wheel{ Card{ FaceValue (1), Suit::Clubs }, Card{ FaceValue (2), Suit::Hearts },
+                                   Card{ FaceValue (3), Suit::Clubs }, Card{ FaceValue (4), Suit::Spades },
+                                   Card{ FaceValue (5), Suit::Clubs } };
+  assert (category (evaluator.evaluate (pack (wheel))) == HandCategory::Straight);
+  assert (evaluator.evaluate (pack (wheel)) == naive_evaluate (wheel));
+  const std::array<Card, 7> royal{ Card{ FaceValue (10), Suit::Spades }, Card{ FaceValue (2), Suit::Hearts },
+                                   Card{ FaceValue (11), Suit::Spades }, Card{ FaceValue (12), Suit::Spades },
+                                   Card{ FaceValue (2), Suit::Clubs },   Card{ FaceValue (13), Suit::Spades },
+                                   Card{ FaceValue (1), Suit::Spades } };
+  assert (category (evaluator.evaluate (pack (royal))) == HandCategory::StraightFlush);
+  assert (evaluator.evaluate (pack (royal)) == naive_evaluate (royal));
+  for (const auto &dealt : decks)
+    {
+      std::array<Card, 7> hand;
+      std::copy_n (dealt.begin (), 7, hand.begin ());
+      assert (evaluator.evaluate (pack (hand)) == naive_evaluate (hand));
+    }
+
+  // A one deck shoe with two Jokers matches the extended deck, and tagged bytes follow the same guessing rules
+  Shoe<1, 2> small_shoe;
+  auto       fresh = create_extended_deck ();
+  assert (std::ranges::equal (small_shoe.undealt (), fresh, {}, {}, [] (const auto &card) { return ShoeCard (card); }));
+  for (const auto &current : fresh)
+    {
+      for (const auto &next : fresh)
+        {
+          for (char guess : { 'h', 'l' })
+            {
+              assert (is_guess_correct (guess, ShoeCard (current), ShoeCard (next))
+                      == is_guess_correct (guess, current, next));
+            }
+        }
+      assert (ShoeCard (ShoeCard (current).to_variant ()) == ShoeCard (current));
+    }
+
+  Shoe<6> shoe (0.5);
+  static_assert (Shoe<6>::size == 312);
+  shoe.shuffle (shuffler);
+  std::array<int, 52> copies{};
+  while (!shoe.needs_reshuffle ())
+    {
+      ++copies[shoe.deal ().card ().index ()];
+    }
+  assert (shoe.dealt ().size () == 156 && shoe.remaining () == 156);
+  for (ShoeCard card : shoe.undealt ())
+    {
+      ++copies[card.card ().index ()];
+    }
+  assert (std::ranges::all_of (copies, [] (int count) { return count == 6; }));
+
+  // Lehmer code ranks: sorted is the first permutation, reversed the last (52! - 1 needs 226 bits)
+  std::array<Card, 52> sorted;
+  std::ranges::copy (as_set, sorted.begin ());
+  assert (rank_deck (sorted) == DeckRank{});
+  std::ranges::reverse (sorted);
+  assert (rank_deck (sorted)[7] >> 2 == 0 && rank_deck (sorted)[7] >> 1 == 1);
+  assert (unrank_deck (rank_deck (sorted)) == sorted);
+
+  const auto log_name = (std::filesystem::temp_directory_path () / "ch5_shuffle_log.bin").string ();
+  std::remove (log_name.c_str ());
+  {
+    ShuffleRecorder recorder (log_name);
+    for (const auto &dealt : decks)
+      {
+        recorder.record (dealt);
+      }
+  }
+  {
+    ShuffleRecorder recorder (log_name); // appends after the existing header
+    auto            shuffled = create_deck ();
+    shuffle_deck (shuffled, recorder);
+    decks.push_back (shuffled);
+  }
+  {
+    ShuffleLogReader reader (log_name);
+    assert (reader.size () == decks.size ());
+    assert (std::filesystem::file_size (log_name) == 24 + decks.size () * deck_rank_bytes);
+    for (std::size_t i = decks.size (); i-- > 0;)
+      {
+        assert (reader.deck (i) == decks[i]);
+      }
+  }
+  // A crash part way through the last record loses it, and only it, whatever is appended later
+  std::filesystem::resize_file (log_name, std::filesystem::file_size (log_name) - 10);
+  decks.pop_back ();
+  {
+    ShuffleRecorder recorder (log_name);
+    auto            shuffled = create_deck ();
+    shuffle_deck (shuffled, recorder);
+    decks.push_back (shuffled);
+  }
+  {
+    ShuffleLogReader reader (log_name);
+    assert (reader.size () == decks.size ());
+    for (std::size_t i = 0; i < decks.size (); ++i)
+      {
+        assert (reader.deck (i) == decks[i]);
+      }
+  }
+  std::remove (log_name.c_str ());
+
+  // Each table keeps its own game, whichever worker runs it
+  TableService tables (10, 3, 1);
+  for (std::uint32_t table = 0; table < 10; ++table)
+    {
+      TurnResult shown = tables.play (table, '?');
+      assert (!shown.correct && shown.score == 0);
+      int score = 0;
+      for (;;)
+        {
+          const char guess  = shown.showing.index () < 26 ? 'h' : 'l';
+          TurnResult played = tables.play (table, guess);
+          assert (played.correct == is_guess_correct (guess, shown.showing, played.showing));
+          if (played.correct)
+            {
+              assert (played.score == ++score);
+            }
+          if (played.game_over)
+            {
+              assert (played.score == score);
+              break;
+            }
+          shown = played;
+        }
+    }
+  tables.stop ();
+  assert (tables.turns () == tables.latencies ().count ());
+
+  // Stopping plays every turn already queued, then refuses any more
+  bool refused = false;
+  try
+    {
+      tables.play (0, 'h');
+    }
+  catch (const std::runtime_error &)
+    {
+      refused = true;
+    }
+  assert (refused);
+  TableService       queued (10, 2, 1);
+  std::vector<Reply> replies (1'000);
+  for (std::size_t i = 0; i < replies.size (); ++i)
+    {
+      assert (queued.submit (static_cast<std::uint32_t> (i % 10), 'h', &replies[i]));
+    }
+  queued.stop ();
+  assert (std::ranges::all_of (replies, [] (const Reply &reply) { return reply.ready.load (); }));
+  assert (queued.turns () == replies.size ());
 }
 
 int
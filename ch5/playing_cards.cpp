@@ -31,15 +31,15 @@ to_string (const Suit &suit)
   switch (suit)
     {
     case Suit::Hearts:
-      return "Hearts" s;
+      return "Hearts"s;
     case Suit::Diamonds:
-      return "Diamonds" s;
+      return "Diamonds"s;
     case Suit::Clubs:
-      return "Clubs" s;
+      return "Clubs"s;
     case Suit::Spades:
-      return "Spades" s;
+      return "Spades"s;
     default:
-      return "?" s;
+      return "?"s;
     }
 }
 
@@ -70,13 +70,13 @@ to_string (const FaceValue &value)
   switch (value.value ())
     {
     case 1:
-      return "Ace" s;
+      return "Ace"s;
     case 11:
-      return "Jack" s;
+      return "Jack"s;
     case 12:
-      return "Queen" s;
+      return "Queen"s;
     case 13:
-      return "King" s;
+      return "King"s;
     default:
       return std::to_string (value.value ());
     }
@@ -42,7 +42,7 @@ public:
   {
     return value_;
   }
-  auto operator<= > (const FaceValue &) const = default; // Added in Listing 5.21 to provide less than
+  auto operator<=> (const FaceValue &) const = default; // Added in Listing 5.21 to provide less than
 private:
   int value_;
 };
@@ -71,7 +71,7 @@ public:
   // }
 
   // Added in Listing 5.21 to provide less than, and more besides
-  auto operator<= > (const Card &) const = default; // means aces low
+  auto operator<=> (const Card &) const = default; // means aces low
 private:
   FaceValue value_{ 1 };
   Suit      suit_{};
@@ -0,0 +1,402 @@
+#include <algorithm>
+#include <bit>
+#include <initializer_list>
+#include <utility>
+
+#include "poker.h"
+
+namespace
+{
+using namespace cards;
+
+constexpr int ranks = 13;
+
+// Poker ranks run from 0 for a two up to 12 for an ace
+int
+poker_rank (int face_value)
+{
+  return (face_value + ranks - 2) % ranks;
+}
+
+constexpr auto card_ranks = [] () {
+  std::array<std::uint8_t, 52> table{};
+  for (int index = 0; index < 52; ++index)
+    {
+      table[index] = static_cast<std::uint8_t> ((index / 4 + ranks - 1) % ranks);
+    }
+  return table;
+}();
+
+HandRank
+make_rank (HandCategory category, std::initializer_list<int> deciding)
+{
+  HandRank rank  = static_cast<HandRank> (category) << 20;
+  int      shift = 16;
+  for (int r : deciding)
+    {
+      rank |= static_cast<HandRank> (r) << shift;
+      shift -= 4;
+    }
+  return rank;
+}
+
+// Highest card of a run of five in the mask, with the ace also playing low, or -1 if there is none
+int
+straight_high (unsigned mask)
+{
+  for (int high = ranks - 1; high >= 4; --high)
+    {
+      if (((mask >> (high - 4)) & 0x1F) == 0x1F)
+        {
+          return high;
+        }
+    }
+  constexpr unsigned wheel = (1u << 12) | 0xF;
+  return (mask & wheel) == wheel ? 3 : -1;
+}
+
+HandRank
+best_flush (unsigned mask)
+{
+  if (std::popcount (mask) < 5)
+    {
+      return 0;
+    }
+  if (int high = straight_high (mask); high >= 0)
+    {
+      return make_rank (HandCategory::StraightFlush, { high });
+    }
+  std::array<int, 5> top{};
+  for (int &r : top)
+    {
+      r = std::bit_width (mask) - 1;
+      mask &= ~(1u << r);
+    }
+  return make_rank (HandCategory::Flush, { top[0], top[1], top[2], top[3], top[4] });
+}
+
+// Best five card hand, ignoring suits, from counts of each rank
+HandRank
+best_unsuited (const std::array<int, ranks> &counts)
+{
+  unsigned present = 0;
+  int      quads = -1, trips = -1, second_trips = -1, pair = -1, second_pair = -1;
+  for (int r = ranks - 1; r >= 0; --r)
+    {
+      present |= counts[r] ? 1u << r : 0;
+      if (counts[r] == 4)
+        {
+          quads = r;
+        }
+      else if (counts[r] == 3)
+        {
+          (trips < 0 ? trips : second_trips) = r;
+        }
+      else if (counts[r] == 2 && second_pair < 0)
+        {
+          (pair < 0 ? pair : second_pair) = r;
+        }
+    }
+  auto kickers = [present] (std::initializer_list<int> used, int count) {
+    unsigned           mask = present;
+    std::array<int, 3> found{};
+    for (int r : used)
+      {
+        mask &= ~(1u << r);
+      }
+    for (int i = 0; i < count; ++i)
+      {
+        found[i] = std::bit_width (mask) - 1;
+        mask &= ~(1u << found[i]);
+      }
+    return found;
+  };
+
+  if (quads >= 0)
+    {
+      return make_rank (HandCategory::FourOfAKind, { quads, kickers ({ quads }, 1)[0] });
+    }
+  if (trips >= 0 && (second_trips >= 0 || pair >= 0))
+    {
+      return make_rank (HandCategory::FullHouse, { trips, std::max (second_trips, pair) });
+    }
+  if (int high = straight_high (present); high >= 0)
+    {
+      return make_rank (HandCategory::Straight, { high });
+    }
+  if (trips >= 0)
+    {
+      auto k = kickers ({ trips }, 2);
+      return make_rank (HandCategory::ThreeOfAKind, { trips, k[0], k[1] });
+    }
+  if (second_pair >= 0)
+    {
+      return make_rank (HandCategory::TwoPair, { pair, second_pair, kickers ({ pair, second_pair }, 1)[0] });
+    }
+  if (pair >= 0)
+    {
+      auto k = kickers ({ pair }, 3);
+      return make_rank (HandCategory::Pair, { pair, k[0], k[1], k[2] });
+    }
+  unsigned           mask = present;
+  std::array<int, 5> top{};
+  for (int &r : top)
+    {
+      r = std::bit_width (mask) - 1;
+      mask &= ~(1u << r);
+    }
+  return make_rank (HandCategory::HighCard, { top[0], top[1], top[2], top[3], top[4] });
+}
+
+// ways[r][k]: how many ways k cards can fall into r ranks, at most four to a rank
+constexpr auto ways = [] () {
+  std::array<std::array<std::uint32_t, 8>, ranks + 1> table{};
+  table[0][0] = 1;
+  for (int r = 1; r <= ranks; ++r)
+    {
+      for (int k = 0; k < 8; ++k)
+        {
+          for (int x = 0; x <= std::min (4, k); ++x)
+            {
+              table[r][k] += table[r - 1][k - x];
+            }
+        }
+    }
+  return table;
+}();
+
+template <typename F>
+void
+for_each_count (std::array<int, ranks> &counts, int rank, int left, F &f)
+{
+  if (rank == ranks)
+    {
+      if (left == 0)
+        {
+          f (counts);
+        }
+      return;
+    }
+  for (int count = 0; count <= std::min (4, left); ++count)
+    {
+      counts[rank] = count;
+      for_each_count (counts, rank + 1, left - count, f);
+    }
+  counts[rank] = 0;
+}
+}
+
+cards::HandCategory
+cards::category (HandRank rank)
+{
+  return static_cast<HandCategory> (rank >> 20);
+}
+
+cards::HandEvaluator::HandEvaluator () : flush_ (1 << ranks)
+{
+  // Number the rank counts with the same total in lexicographic order: a rank holding c cards
+  // skips every arrangement of the remaining ranks that gave it fewer
+  for (int r = 0; r < ranks; ++r)
+    {
+      for (int left = 0; left < 8; ++left)
+        {
+          for (int count = 1; count <= 4; ++count)
+            {
+              const int skipped             = count - 1;
+              hash_offsets_[r][left][count] = hash_offsets_[r][left][count - 1]
+                                              + (left >= skipped ? ways[ranks - 1 - r][left - skipped] : 0);
+            }
+        }
+    }
+
+  for (std::size_t cards = 5; cards < unsuited_.size (); ++cards)
+    {
+      unsuited_[cards].resize (ways[ranks][cards]);
+      std::array<int, ranks> counts{};
+      auto                   record = [&] (const std::array<int, ranks> &c) {
+        std::uint32_t hash = 0;
+        int           left = static_cast<int> (cards);
+        for (int r = 0; r < ranks; ++r)
+          {
+            hash += hash_offsets_[r][left][c[r]];
+            left -= c[r];
+          }
+        unsuited_[cards][hash] = best_unsuited (c);
+      };
+      for_each_count (counts, 0, static_cast<int> (cards), record);
+    }
+
+  for (unsigned mask = 0; mask < flush_.size (); ++mask)
+    {
+      flush_[mask] = best_flush (mask);
+    }
+
+  for (unsigned key = 0; key < flush_suit_.size (); ++key)
+    {
+      flush_suit_[key] = 4;
+      for (unsigned suit = 0; suit < 4; ++suit)
+        {
+          if (((key >> (3 * suit)) & 7) >= 5)
+            {
+              flush_suit_[key] = static_cast<std::uint8_t> (suit);
+            }
+        }
+    }
+}
+
+template <std::size_t N>
+cards::HandRank
+cards::HandEvaluator::evaluate_cards (const std::array<PackedCard, N> &hand) const
+{
+  std::array<std::uint8_t, ranks> counts{};
+  std::array<unsigned, 5>         suit_masks{}; // the fifth stays empty for "no flush"
+  unsigned                        suit_counts = 0;
+  for (PackedCard card : hand)
+    {
+      const int rank = card_ranks[card.index ()];
+      const int suit = card.index () & 3;
+      ++counts[rank];
+      suit_masks[suit] |= 1u << rank;
+      suit_counts += 1u << (3 * suit);
+    }
+  std::uint32_t hash = 0;
+  int           left = static_cast<int> (N);
+  for (int r = 0; r < ranks; ++r)
+    {
+      hash += hash_offsets_[r][left][counts[r]];
+      left -= counts[r];
+    }
+  return std::max (unsuited_[N][hash], flush_[suit_masks[flush_suit_[suit_counts]]]);
+}
+
+cards::HandRank
+cards::HandEvaluator::evaluate (const std::array<PackedCard, 5> &hand) const
+{
+  return evaluate_cards (hand);
+}
+
+cards::HandRank
+cards::HandEvaluator::evaluate (const std::array<PackedCard, 7> &hand) const
+{
+  return evaluate_cards (hand);
+}
+
+void
+cards::HandEvaluator::evaluate (std::span<const std::array<PackedCard, 5> > hands, std::span<HandRank> ranks) const
+{
+  std::ranges::transform (hands, ranks.begin (), [this] (const auto &hand) { return evaluate_cards (hand); });
+}
+
+void
+cards::HandEvaluator::evaluate (std::span<const std::array<PackedCard, 7> > hands, std::span<HandRank> ranks) const
+{
+  std::ranges::transform (hands, ranks.begin (), [this] (const auto &hand) { return evaluate_cards (hand); });
+}
+
+cards::HandRank
+cards::naive_evaluate (const std::array<Card, 5> &hand)
+{
+  std::array<int, 5> values;
+  std::ranges::transform (hand, values.begin (), [] (const Card &card) { return poker_rank (card.value ().value ()); });
+  std::ranges::sort (values, std::greater<> ());
+  const bool flush
+      = std::ranges::all_of (hand, [&hand] (const Card &card) { return card.suit () == hand[0].suit (); });
+
+  // Group equal ranks, biggest group first, then highest rank first
+  std::vector<std::pair<int, int> > groups; // count, rank
+  for (int value : values)
+    {
+      if (!groups.empty () && groups.back ().second == value)
+        {
+          ++groups.back ().first;
+        }
+      else
+        {
+          groups.emplace_back (1, value);
+        }
+    }
+  std::ranges::stable_sort (groups, std::greater<> (), &std::pair<int, int>::first);
+
+  int high = -1;
+  if (groups.size () == 5)
+    {
+      if (values[0] - values[4] == 4)
+        {
+          high = values[0];
+        }
+      else if (values == std::array{ 12, 3, 2, 1, 0 })
+        {
+          high = 3;
+        }
+    }
+
+  HandCategory category = HandCategory::HighCard;
+  if (high >= 0 && flush)
+    {
+      category = HandCategory::StraightFlush;
+    }
+  else if (groups[0].first == 4)
+    {
+      category = HandCategory::FourOfAKind;
+    }
+  else if (groups[0].first == 3 && groups[1].first == 2)
+    {
+      category = HandCategory::FullHouse;
+    }
+  else if (flush)
+    {
+      category = HandCategory::Flush;
+    }
+  else if (high >= 0)
+    {
+      category = HandCategory::Straight;
+    }
+  else if (groups[0].first == 3)
+    {
+      category = HandCategory::ThreeOfAKind;
+    }
+  else if (groups[0].first == 2 && groups[1].first == 2)
+    {
+      category = HandCategory::TwoPair;
+    }
+  else if (groups[0].first == 2)
+    {
+      category = HandCategory::Pair;
+    }
+
+  HandRank rank = static_cast<HandRank> (category) << 20;
+  if (category == HandCategory::Straight || category == HandCategory::StraightFlush)
+    {
+      return rank | static_cast<HandRank> (high) << 16;
+    }
+  int shift = 16;
+  for (const auto &[count, value] : groups)
+    {
+      rank |= static_cast<HandRank> (value) << shift;
+      shift -= 4;
+    }
+  return rank;
+}
+
+cards::HandRank
+cards::naive_evaluate (const std::array<Card, 7> &hand)
+{
+  HandRank best = 0;
+  for (std::size_t skip_first = 0; skip_first < hand.size (); ++skip_first)
+    {
+      for (std::size_t skip_second = skip_first + 1; skip_second < hand.size (); ++skip_second)
+        {
+          std::array<Card, 5> five;
+          auto                out = five.begin ();
+          for (std::size_t i = 0; i < hand.size (); ++i)
+            {
+              if (i != skip_first && i != skip_second)
+                {
+                  *out++ = hand[i];
+                }
+            }
+          best = std::max (best, naive_evaluate (five));
+        }
+    }
+  return best;
+}
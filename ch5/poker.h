@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "card_set.h"
+#include "playing_cards.h"
+
+namespace cards
+{
+enum class HandCategory
+{
+  HighCard,
+  Pair,
+  TwoPair,
+  ThreeOfAKind,
+  Straight,
+  Flush,
+  FullHouse,
+  FourOfAKind,
+  StraightFlush
+};
+
+// Higher is better: the category in bits 20 up, then the five deciding ranks (aces high, 0 for a two)
+// four bits apiece, most significant first
+using HandRank = std::uint32_t;
+
+HandCategory category (HandRank rank);
+
+// Ranks 5 and best-of-7 card poker hands with table lookups instead of sorting.
+// Each hand is reduced to rank counts, which a perfect hash maps to its best non-flush hand, and to a
+// rank mask per suit; a suit count lookup picks the flushed suit, if any, whose mask indexes the flush table.
+// A hand's rank is the better of the two, so the only branches are the loops over cards and ranks.
+class HandEvaluator
+{
+public:
+  HandEvaluator ();
+
+  HandRank evaluate (const std::array<PackedCard, 5> &hand) const;
+  HandRank evaluate (const std::array<PackedCard, 7> &hand) const;
+
+  void evaluate (std::span<const std::array<PackedCard, 5> > hands, std::span<HandRank> ranks) const;
+  void evaluate (std::span<const std::array<PackedCard, 7> > hands, std::span<HandRank> ranks) const;
+
+private:
+  template <std::size_t N> HandRank evaluate_cards (const std::array<PackedCard, N> &hand) const;
+
+  // hash_offsets_[rank][cards still to place][count of this rank]
+  std::array<std::array<std::array<std::uint32_t, 5>, 8>, 13> hash_offsets_{};
+  // Best non-flush hand, by perfect hash of the rank counts, for 5, 6 and 7 cards
+  std::array<std::vector<HandRank>, 8> unsuited_;
+  // Best flush or straight flush for a mask of ranks in one suit; zero for fewer than five
+  std::vector<HandRank> flush_;
+  // Which suit has five or more cards, by three-bit suit counts; 4 when none has
+  std::array<std::uint8_t, 1 << 12> flush_suit_{};
+};
+
+// Straightforward evaluators on Card, sorting each hand and trying all 21 fives from seven
+HandRank naive_evaluate (const std::array<Card, 5> &hand);
+HandRank naive_evaluate (const std::array<Card, 7> &hand);
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "poker.h"
+#include "shuffler.h"
+
+namespace
+{
+using namespace cards;
+
+template <std::size_t N>
+std::vector<std::array<PackedCard, N> >
+deal_hands (std::size_t count, Shuffler &shuffler)
+{
+  std::array<PackedCard, 52> deck;
+  std::ranges::copy (CardSet::full_deck (), deck.begin ());
+  std::vector<std::array<PackedCard, N> > hands (count);
+  for (auto &hand : hands)
+    {
+      shuffler.shuffle (deck);
+      std::copy_n (deck.begin (), N, hand.begin ());
+    }
+  return hands;
+}
+
+template <typename F>
+double
+hands_per_second (std::size_t count, F evaluate)
+{
+  auto start = std::chrono::steady_clock::now ();
+  evaluate ();
+  auto elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now () - start);
+  return count / elapsed.count ();
+}
+
+template <std::size_t N>
+void
+compare (const HandEvaluator &evaluator, std::size_t count, Shuffler &shuffler)
+{
+  const auto hands = deal_hands<N> (count, shuffler);
+  std::vector<std::array<Card, N> > as_cards (count);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      std::ranges::transform (hands[i], as_cards[i].begin (), &PackedCard::to_card);
+    }
+
+  std::vector<HandRank> table_ranks (count);
+  std::vector<HandRank> naive_ranks (count);
+  const double          table_rate
+      = hands_per_second (count, [&] () { evaluator.evaluate (std::span (hands), std::span (table_ranks)); });
+  const double naive_rate = hands_per_second (count, [&] () {
+    std::ranges::transform (as_cards, naive_ranks.begin (), [] (const auto &hand) { return naive_evaluate (hand); });
+  });
+
+  std::cout << N << " card hands: table " << table_rate << " hands/s, naive " << naive_rate << " hands/s ("
+            << table_rate / naive_rate << "x)" << (table_ranks == naive_ranks ? "" : " MISMATCH") << '\n';
+}
+}
+
+int
+main (int argc, char *argv[])
+{
+  const std::size_t count = argc > 1 ? std::stoull (argv[1]) : 1'000'000;
+  Shuffler          shuffler (2024);
+
+  auto                start = std::chrono::steady_clock::now ();
+  const HandEvaluator evaluator;
+  std::cout << "Tables built in "
+            << std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ()
+            << "ms\n";
+
+  compare<5> (evaluator, count, shuffler);
+  compare<7> (evaluator, count, shuffler);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <variant>
+
+#include "card_set.h"
+#include "playing_cards.h"
+#include "shuffler.h"
+
+namespace cards
+{
+// A card or a Joker in one byte: a PackedCard in the low six bits, with a tag bit for Jokers,
+// in place of std::variant<Card, Joker>
+class ShoeCard
+{
+public:
+  ShoeCard () = default;
+  explicit ShoeCard (PackedCard card) : bits_ (static_cast<std::uint8_t> (card.index ())) {}
+  explicit ShoeCard (const Card &card) : ShoeCard (PackedCard (card)) {}
+  explicit ShoeCard (Joker) : bits_ (joker_bit) {}
+  explicit ShoeCard (const std::variant<Card, Joker> &card)
+      : ShoeCard (std::holds_alternative<Joker> (card) ? ShoeCard (Joker{}) : ShoeCard (std::get<Card> (card)))
+  {
+  }
+
+  bool
+  is_joker () const
+  {
+    return (bits_ & joker_bit) != 0;
+  }
+  // Precondition: not a Joker
+  PackedCard
+  card () const
+  {
+    return PackedCard::from_index (bits_);
+  }
+  std::variant<Card, Joker>
+  to_variant () const
+  {
+    if (is_joker ())
+      {
+        return Joker{};
+      }
+    return card ().to_card ();
+  }
+
+  bool operator== (const ShoeCard &) const = default;
+
+  // Listing 5.30's rules without holds_alternative: a Joker either side is a free go
+  friend bool
+  is_guess_correct (char guess, ShoeCard current, ShoeCard next)
+  {
+    const bool free_go = ((current.bits_ | next.bits_) & joker_bit) != 0;
+    return free_go || (guess == 'h' && next.bits_ > current.bits_) || (guess == 'l' && next.bits_ < current.bits_);
+  }
+
+private:
+  static constexpr std::uint8_t joker_bit = 0x40;
+
+  std::uint8_t bits_{};
+};
+
+static_assert (sizeof (ShoeCard) == 1);
+
+// Decks full decks and Jokers Jokers, sized at compile time, dealt from the front with a cursor.
+// Shoe<1, 0> and Shoe<1, 2> start in the same order as create_deck and create_extended_deck.
+// Once the cursor passes the cut card, placed at the given penetration, it is time to reshuffle.
+template <int Decks, int Jokers = 0> class Shoe
+{
+public:
+  static constexpr std::size_t size = Decks * 52 + Jokers;
+
+  explicit Shoe (double penetration = 0.75) : cut_ (static_cast<std::size_t> (size * penetration))
+  {
+    auto card = cards_.begin ();
+    for (int joker = 0; joker < Jokers; ++joker)
+      {
+        *card++ = ShoeCard (Joker{});
+      }
+    for (int deck = 0; deck < Decks; ++deck)
+      {
+        for (int suit = 0; suit < 4; ++suit)
+          {
+            for (int value = 0; value < 13; ++value)
+              {
+                *card++ = ShoeCard (PackedCard::from_index (value * 4 + suit));
+              }
+          }
+      }
+  }
+
+  // Shuffles every card back in, dealt or not
+  void
+  shuffle (Shuffler &shuffler)
+  {
+    shuffler.shuffle (cards_);
+    next_ = 0;
+  }
+
+  // Precondition: remaining () > 0
+  ShoeCard
+  deal ()
+  {
+    return cards_[next_++];
+  }
+  ShoeCard
+  peek (std::size_t ahead = 0) const
+  {
+    return cards_[next_ + ahead];
+  }
+
+  std::size_t
+  remaining () const
+  {
+    return size - next_;
+  }
+  bool
+  needs_reshuffle () const
+  {
+    return next_ >= cut_;
+  }
+
+  std::span<const ShoeCard>
+  dealt () const
+  {
+    return std::span<const ShoeCard> (cards_).first (next_);
+  }
+  std::span<const ShoeCard>
+  undealt () const
+  {
+    return std::span<const ShoeCard> (cards_).subspan (next_);
+  }
+
+private:
+  std::array<ShoeCard, size> cards_;
+  std::size_t                next_{};
+  std::size_t                cut_;
+};
+}
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "card_set.h"
+#include "shuffle_log.h"
+
+namespace
+{
+using namespace cards;
+
+constexpr char          magic[8]     = { 'S', 'H', 'U', 'F', 'L', 'O', 'G', '1' };
+constexpr std::uint32_t version      = 1;
+constexpr std::size_t   header_bytes = 24;
+
+void
+put_u32 (unsigned char *out, std::uint32_t value)
+{
+  for (int i = 0; i < 4; ++i)
+    {
+      out[i] = static_cast<unsigned char> (value >> (8 * i));
+    }
+}
+
+std::uint32_t
+get_u32 (const unsigned char *in)
+{
+  std::uint32_t value = 0;
+  for (int i = 0; i < 4; ++i)
+    {
+      value |= static_cast<std::uint32_t> (in[i]) << (8 * i);
+    }
+  return value;
+}
+
+std::array<unsigned char, header_bytes>
+make_header ()
+{
+  std::array<unsigned char, header_bytes> header{};
+  std::copy (std::begin (magic), std::end (magic), header.begin ());
+  put_u32 (&header[8], version);
+  put_u32 (&header[12], 52);
+  put_u32 (&header[16], deck_rank_bytes);
+  return header;
+}
+
+bool
+header_ok (const unsigned char *header)
+{
+  return std::equal (std::begin (magic), std::end (magic), header) && get_u32 (header + 8) == version
+         && get_u32 (header + 12) == 52 && get_u32 (header + 16) == deck_rank_bytes;
+}
+
+// rank = rank * radix + digit
+void
+multiply_add (DeckRank &rank, std::uint32_t radix, std::uint32_t digit)
+{
+  std::uint64_t carry = digit;
+  for (auto &word : rank)
+    {
+      const std::uint64_t product = static_cast<std::uint64_t> (word) * radix + carry;
+      word                        = static_cast<std::uint32_t> (product);
+      carry                       = product >> 32;
+    }
+}
+
+// rank /= radix, returning the remainder
+std::uint32_t
+divide (DeckRank &rank, std::uint32_t radix)
+{
+  std::uint64_t remainder = 0;
+  for (auto word = rank.rbegin (); word != rank.rend (); ++word)
+    {
+      const std::uint64_t value = (remainder << 32) | *word;
+      *word                     = static_cast<std::uint32_t> (value / radix);
+      remainder                 = value % radix;
+    }
+  return static_cast<std::uint32_t> (remainder);
+}
+}
+
+// Digit i of the Lehmer code counts the cards after position i which are lower than deck[i]
+cards::DeckRank
+cards::rank_deck (const std::array<Card, 52> &deck)
+{
+  DeckRank rank{};
+  CardSet  remaining = CardSet::full_deck ();
+  for (std::size_t i = 0; i < deck.size (); ++i)
+    {
+      const PackedCard card (deck[i]);
+      multiply_add (rank, static_cast<std::uint32_t> (deck.size () - i), remaining.below (card).size ());
+      remaining.erase (card);
+    }
+  return rank;
+}
+
+std::array<cards::Card, 52>
+cards::unrank_deck (const DeckRank &rank)
+{
+  std::array<std::uint32_t, 52> digits;
+  DeckRank                      left = rank;
+  for (std::size_t i = digits.size (); i-- > 0;)
+    {
+      digits[i] = divide (left, static_cast<std::uint32_t> (digits.size () - i));
+    }
+
+  std::array<Card, 52> deck;
+  CardSet              remaining = CardSet::full_deck ();
+  for (std::size_t i = 0; i < deck.size (); ++i)
+    {
+      std::uint64_t mask = remaining.mask ();
+      for (std::uint32_t skip = 0; skip < digits[i]; ++skip)
+        {
+          mask &= mask - 1;
+        }
+      const PackedCard card = CardSet (mask).lowest ();
+      deck[i]               = card.to_card ();
+      remaining.erase (card);
+    }
+  return deck;
+}
+
+cards::ShuffleRecorder::ShuffleRecorder (const std::string &filename)
+{
+  std::error_code ec;
+  const auto      existing = std::filesystem::file_size (filename, ec);
+  if (!ec && existing > 0)
+    {
+      std::array<unsigned char, header_bytes> header{};
+      std::ifstream                           in{ filename, std::ios::binary };
+      in.read (reinterpret_cast<char *> (header.data ()), header.size ());
+      if (!in || !header_ok (header.data ()))
+        {
+          throw std::runtime_error ("Not a shuffle log: " + filename);
+        }
+      // Drop a record cut short by a crash, or every one appended after it would be out of line
+      const auto whole = header_bytes + (existing - header_bytes) / deck_rank_bytes * deck_rank_bytes;
+      if (whole != existing)
+        {
+          in.close ();
+          std::filesystem::resize_file (filename, whole);
+        }
+    }
+
+  out_.open (filename, std::ios::binary | std::ios::app);
+  if (!out_)
+    {
+      throw std::runtime_error ("Failed to open " + filename);
+    }
+  if (ec || existing == 0)
+    {
+      const auto header = make_header ();
+      out_.write (reinterpret_cast<const char *> (header.data ()), header.size ());
+    }
+}
+
+void
+cards::ShuffleRecorder::record (const std::array<Card, 52> &deck)
+{
+  const DeckRank                             rank = rank_deck (deck);
+  std::array<unsigned char, deck_rank_bytes> bytes;
+  for (std::size_t i = 0; i < bytes.size (); ++i)
+    {
+      bytes[i] = static_cast<unsigned char> (rank[i / 4] >> (8 * (i % 4)));
+    }
+  out_.write (reinterpret_cast<const char *> (bytes.data ()), bytes.size ());
+}
+
+void
+cards::ShuffleRecorder::flush ()
+{
+  out_.flush ();
+}
+
+void
+cards::shuffle_deck (std::array<Card, 52> &deck, ShuffleRecorder &recorder)
+{
+  shuffle_deck (deck);
+  recorder.record (deck);
+}
+
+cards::ShuffleLogReader::ShuffleLogReader (const std::string &filename)
+{
+  const int fd = ::open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      throw std::runtime_error ("Failed to open " + filename);
+    }
+  struct stat status;
+  if (::fstat (fd, &status) != 0 || static_cast<std::size_t> (status.st_size) < header_bytes)
+    {
+      ::close (fd);
+      throw std::runtime_error ("Not a shuffle log: " + filename);
+    }
+  length_     = static_cast<std::size_t> (status.st_size);
+  void *start = ::mmap (nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close (fd);
+  if (start == MAP_FAILED)
+    {
+      throw std::runtime_error ("Failed to map " + filename);
+    }
+  data_ = static_cast<const unsigned char *> (start);
+  if (!header_ok (data_))
+    {
+      ::munmap (start, length_);
+      throw std::runtime_error ("Not a shuffle log: " + filename);
+    }
+  // A record cut short by a crash while appending is ignored
+  size_ = (length_ - header_bytes) / deck_rank_bytes;
+}
+
+cards::ShuffleLogReader::~ShuffleLogReader ()
+{
+  ::munmap (const_cast<unsigned char *> (data_), length_);
+}
+
+cards::DeckRank
+cards::ShuffleLogReader::rank (std::size_t deck_number) const
+{
+  if (deck_number >= size_)
+    {
+      throw std::out_of_range ("No such deck in shuffle log");
+    }
+  const unsigned char *bytes = data_ + header_bytes + deck_number * deck_rank_bytes;
+  DeckRank             rank{};
+  for (std::size_t i = 0; i < deck_rank_bytes; ++i)
+    {
+      rank[i / 4] |= static_cast<std::uint32_t> (bytes[i]) << (8 * (i % 4));
+    }
+  return rank;
+}
+
+std::array<cards::Card, 52>
+cards::ShuffleLogReader::deck (std::size_t deck_number) const
+{
+  return unrank_deck (rank (deck_number));
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "playing_cards.h"
+
+namespace cards
+{
+// A permutation of 52 cards numbered by its Lehmer code: 52! < 2^226, so 29 bytes are enough.
+// Held as little endian 32-bit words.
+using DeckRank = std::array<std::uint32_t, 8>;
+
+constexpr std::size_t deck_rank_bytes = 29;
+
+DeckRank             rank_deck (const std::array<Card, 52> &deck);
+std::array<Card, 52> unrank_deck (const DeckRank &rank);
+
+// Appends each deck's rank to a binary file. The file starts with a small header, followed by
+// fixed size records, so the block holding deck n is found by arithmetic rather than a stored index.
+class ShuffleRecorder
+{
+public:
+  explicit ShuffleRecorder (const std::string &filename);
+
+  void record (const std::array<Card, 52> &deck);
+  void flush ();
+
+private:
+  std::ofstream out_;
+};
+
+void shuffle_deck (std::array<Card, 52> &deck, ShuffleRecorder &recorder);
+
+// Memory maps a file written by ShuffleRecorder and decodes any deck in it
+class ShuffleLogReader
+{
+public:
+  explicit ShuffleLogReader (const std::string &filename);
+  ~ShuffleLogReader ();
+  ShuffleLogReader (const ShuffleLogReader &)            = delete;
+  ShuffleLogReader &operator= (const ShuffleLogReader &) = delete;
+
+  std::size_t
+  size () const
+  {
+    return size_;
+  }
+  DeckRank             rank (std::size_t deck_number) const;
+  std::array<Card, 52> deck (std::size_t deck_number) const;
+
+private:
+  const unsigned char *data_{};
+  std::size_t          length_{};
+  std::size_t          size_{};
+};
+}
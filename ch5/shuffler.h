@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace cards
+{
+// xoshiro256** (Blackman and Vigna): a small, fast engine meeting the UniformRandomBitGenerator requirements,
+// so it can also be handed to std::ranges::shuffle or the std distributions
+class Xoshiro256
+{
+public:
+  using result_type = std::uint64_t;
+
+  explicit Xoshiro256 (std::uint64_t seed)
+  {
+    // splitmix64 spreads a single seed across the four words of state
+    for (auto &word : state_)
+      {
+        seed += 0x9E3779B97F4A7C15;
+        std::uint64_t z = seed;
+        z               = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z               = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        word            = z ^ (z >> 31);
+      }
+  }
+
+  static constexpr result_type
+  min ()
+  {
+    return 0;
+  }
+  static constexpr result_type
+  max ()
+  {
+    return std::numeric_limits<result_type>::max ();
+  }
+
+  result_type
+  operator() ()
+  {
+    const std::uint64_t result = rotl (state_[1] * 5, 7) * 9;
+    const std::uint64_t t      = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotl (state_[3], 45);
+    return result;
+  }
+
+private:
+  static std::uint64_t
+  rotl (std::uint64_t x, int k)
+  {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  std::array<std::uint64_t, 4> state_{};
+};
+
+// Shuffles decks with an engine built once, rather than a random_device and mt19937 per shuffle
+// as in shuffle_deck. Works for any random access deck, so both std::array<Card, 52>
+// and std::array<std::variant<Card, Joker>, 54>.
+class Shuffler
+{
+public:
+  Shuffler () : engine_ (std::random_device{}()) {}
+  explicit Shuffler (std::uint64_t seed) : engine_ (seed) {}
+
+  // A uniform value in [0, n) using Lemire's multiply-shift; the modulus is only
+  // needed on the rare path where the low half of the product could be biased
+  std::uint32_t
+  bounded (std::uint32_t n)
+  {
+    std::uint64_t product = static_cast<std::uint64_t> (next32 ()) * n;
+    auto          low     = static_cast<std::uint32_t> (product);
+    if (low < n)
+      {
+        const std::uint32_t threshold = (0u - n) % n;
+        while (low < threshold)
+          {
+            product = static_cast<std::uint64_t> (next32 ()) * n;
+            low     = static_cast<std::uint32_t> (product);
+          }
+      }
+    return static_cast<std::uint32_t> (product >> 32);
+  }
+
+  // Fisher-Yates
+  template <std::ranges::random_access_range R>
+  void
+  shuffle (R &&deck)
+  {
+    auto first = std::ranges::begin (deck);
+    for (auto i = static_cast<std::uint32_t> (std::ranges::size (deck)); i > 1; --i)
+      {
+        std::ranges::iter_swap (first + (i - 1), first + bounded (i));
+      }
+  }
+
+  // Fill a contiguous buffer with independently shuffled copies of a fresh deck
+  template <typename Deck>
+  void
+  deal (const Deck &fresh, std::span<Deck> decks)
+  {
+    for (auto &deck : decks)
+      {
+        deck = fresh;
+        shuffle (deck);
+      }
+  }
+  template <typename Deck>
+  std::vector<Deck>
+  deal (const Deck &fresh, std::size_t count)
+  {
+    std::vector<Deck> decks (count);
+    deal (fresh, std::span<Deck> (decks));
+    return decks;
+  }
+
+  Xoshiro256 &
+  engine ()
+  {
+    return engine_;
+  }
+
+private:
+  // Each 64-bit draw is used as two 32-bit values
+  std::uint32_t
+  next32 ()
+  {
+    if (spare_)
+      {
+        spare_ = false;
+        return static_cast<std::uint32_t> (buffered_ >> 32);
+      }
+    buffered_ = engine_ ();
+    spare_    = true;
+    return static_cast<std::uint32_t> (buffered_);
+  }
+
+  Xoshiro256    engine_;
+  std::uint64_t buffered_{};
+  bool          spare_{};
+};
+}
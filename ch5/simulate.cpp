@@ -0,0 +1,44 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "simulator.h"
+#include "solver.h"
+
+// Compare higher/lower strategies by playing them many times
+int
+main (int argc, char *argv[])
+{
+  using namespace cards;
+  SimulationOptions options;
+  if (argc > 1)
+    {
+      options.games = std::stoull (argv[1]);
+    }
+  if (argc > 2)
+    {
+      options.threads = static_cast<unsigned> (std::stoul (argv[2]));
+    }
+
+  const std::pair<const char *, Strategy> strategies[] = {
+    { "Always higher", always_higher },
+    { "Guess by midpoint", guess_by_midpoint },
+    { "Count cards", count_cards },
+    { "Play optimally", play_optimally },
+  };
+  for (bool jokers : { false, true })
+    {
+      options.jokers = jokers;
+      std::cout << "Exact optimal expected score" << (jokers ? " - Jokers a free go: " : ": ")
+                << HigherLowerSolver (jokers ? 2 : 0).expected_score () << "\n\n";
+      for (const auto &[name, strategy] : strategies)
+        {
+          auto start   = std::chrono::steady_clock::now ();
+          auto result  = simulate (strategy, options);
+          auto elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now () - start);
+          std::cout << name << (jokers ? " - Jokers a free go" : "") << " (" << elapsed.count () << "s, "
+                    << options.games / elapsed.count () << " games/s)\n"
+                    << result << '\n';
+        }
+    }
+}
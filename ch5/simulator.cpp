@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "shuffler.h"
+#include "simulator.h"
+
+namespace
+{
+using namespace cards;
+
+// Jokers in the 54 card deck are packed after the King of Spades
+constexpr int joker_index = 52;
+
+bool
+is_joker (PackedCard card)
+{
+  return card.index () >= joker_index;
+}
+
+template <std::size_t N>
+std::array<PackedCard, N>
+fresh_deck ()
+{
+  std::array<PackedCard, N> deck;
+  for (std::size_t i = 0; i < N; ++i)
+    {
+      deck[i] = PackedCard::from_index (static_cast<int> (i));
+    }
+  return deck;
+}
+
+// A contiguous run of chunks owned by one thread; the owner and thieves both claim from next
+struct alignas (64) WorkRange
+{
+  std::atomic<std::uint64_t> next{};
+  std::uint64_t              end{};
+};
+
+constexpr std::uint64_t chunk_size = 4096;
+
+std::uint64_t
+chunk_seed (std::uint64_t seed, std::uint64_t chunk)
+{
+  return seed ^ (chunk * 0x9E3779B97F4A7C15);
+}
+
+template <std::size_t N, typename Play>
+void
+play_chunk (std::uint64_t chunk, const SimulationOptions &options, Play play, SimulationResult &result)
+{
+  Shuffler            shuffler (chunk_seed (options.seed, chunk));
+  auto                deck  = fresh_deck<N> ();
+  const std::uint64_t first = chunk * chunk_size;
+  const std::uint64_t last  = std::min (first + chunk_size, options.games);
+  for (std::uint64_t game = first; game < last; ++game)
+    {
+      shuffler.shuffle (deck);
+      ++result.scores[play (deck)];
+    }
+}
+
+template <std::size_t N, typename Play>
+SimulationResult
+run (const SimulationOptions &options, Play play)
+{
+  const unsigned threads
+      = options.threads ? options.threads : std::max (1u, std::thread::hardware_concurrency ());
+  const std::uint64_t chunks = (options.games + chunk_size - 1) / chunk_size;
+
+  std::vector<WorkRange> ranges (threads);
+  for (unsigned i = 0; i < threads; ++i)
+    {
+      ranges[i].next = chunks * i / threads;
+      ranges[i].end  = chunks * (i + 1) / threads;
+    }
+
+  std::vector<SimulationResult> results (threads);
+  {
+    std::vector<std::jthread> workers;
+    for (unsigned self = 0; self < threads; ++self)
+      {
+        workers.emplace_back ([&, self] () {
+          // Work through our own range first, then steal from the others in turn
+          SimulationResult local;
+          for (unsigned offset = 0; offset < threads; ++offset)
+            {
+              WorkRange &range = ranges[(self + offset) % threads];
+              for (std::uint64_t chunk = range.next++; chunk < range.end; chunk = range.next++)
+                {
+                  play_chunk<N> (chunk, options, play, local);
+                }
+            }
+          results[self] = local;
+        });
+      }
+  }
+
+  SimulationResult total;
+  for (const auto &result : results)
+    {
+      std::ranges::transform (total.scores, result.scores, total.scores.begin (), std::plus<> ());
+    }
+  return total;
+}
+}
+
+char
+cards::always_higher (PackedCard, CardSet)
+{
+  return 'h';
+}
+
+char
+cards::guess_by_midpoint (PackedCard current, CardSet)
+{
+  return current.index () < 26 ? 'h' : 'l';
+}
+
+char
+cards::count_cards (PackedCard current, CardSet seen)
+{
+  CardSet unseen = CardSet::full_deck () - seen;
+  return unseen.above (current).size () >= unseen.below (current).size () ? 'h' : 'l';
+}
+
+std::uint64_t
+cards::SimulationResult::games () const
+{
+  return std::accumulate (scores.begin (), scores.end (), std::uint64_t{});
+}
+
+double
+cards::SimulationResult::mean () const
+{
+  std::uint64_t total = 0;
+  for (std::size_t index = 0; index < scores.size (); ++index)
+    {
+      total += index * scores[index];
+    }
+  return games () ? static_cast<double> (total) / games () : 0.0;
+}
+
+std::ostream &
+cards::operator<< (std::ostream &os, const SimulationResult &result)
+{
+  os << result.games () << " games, mean score " << result.mean () << '\n';
+  for (std::size_t index = 0; index < result.scores.size (); ++index)
+    {
+      if (result.scores[index])
+        {
+          os << std::setw (3) << index << ' ' << result.scores[index] << '\n';
+        }
+    }
+  return os;
+}
+
+// Same loop as higher_lower, with the strategy in place of std::cin
+int
+cards::play_higher_lower (Strategy strategy, const std::array<PackedCard, 52> &deck)
+{
+  CardSet     seen;
+  std::size_t index = 0;
+  seen.insert (deck[index]);
+  while (index + 1 < deck.size ())
+    {
+      if (!is_guess_correct (strategy (deck[index], seen), deck[index], deck[index + 1]))
+        {
+          break;
+        }
+      ++index;
+      seen.insert (deck[index]);
+    }
+  return static_cast<int> (index);
+}
+
+// Same loop as higher_lower_with_jokers: a Joker either side of the guess is a free go
+int
+cards::play_higher_lower_with_jokers (Strategy strategy, const std::array<PackedCard, 54> &deck)
+{
+  CardSet     seen;
+  std::size_t index = 0;
+  while (index + 1 < deck.size ())
+    {
+      const PackedCard current = deck[index];
+      const PackedCard next    = deck[index + 1];
+      if (!is_joker (current))
+        {
+          seen.insert (current);
+          if (!is_joker (next) && !is_guess_correct (strategy (current, seen), current, next))
+            {
+              break;
+            }
+        }
+      ++index;
+    }
+  return static_cast<int> (index);
+}
+
+cards::SimulationResult
+cards::simulate (Strategy strategy, const SimulationOptions &options)
+{
+  if (options.jokers)
+    {
+      return run<54> (options,
+                      [strategy] (const auto &deck) { return play_higher_lower_with_jokers (strategy, deck); });
+    }
+  return run<52> (options, [strategy] (const auto &deck) { return play_higher_lower (strategy, deck); });
+}
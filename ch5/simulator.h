@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+
+#include "card_set.h"
+
+namespace cards
+{
+// A strategy for higher_lower: given the card showing and every card seen so far
+// (including the one showing), return 'h' or 'l'
+using Strategy = char (*) (PackedCard current, CardSet seen);
+
+char always_higher (PackedCard current, CardSet seen);
+char guess_by_midpoint (PackedCard current, CardSet seen);
+char count_cards (PackedCard current, CardSet seen);
+
+struct SimulationOptions
+{
+  std::uint64_t games   = 1'000'000;
+  unsigned      threads = 0; // 0 means std::thread::hardware_concurrency
+  std::uint64_t seed    = 0;
+  bool          jokers  = false; // play higher_lower_with_jokers rules
+};
+
+// How many games ended with each index, i.e. each number of correct guesses
+struct SimulationResult
+{
+  std::array<std::uint64_t, 54> scores{};
+
+  std::uint64_t games () const;
+  double        mean () const;
+};
+
+std::ostream &operator<< (std::ostream &os, const SimulationResult &result);
+
+// Play higher_lower (or higher_lower_with_jokers) without a human, many times over.
+// Games are split into chunks that threads claim and steal from one another, and each chunk
+// seeds its own engine from the options' seed, so a given seed gives the same result on any number of threads.
+SimulationResult simulate (Strategy strategy, const SimulationOptions &options);
+
+int play_higher_lower (Strategy strategy, const std::array<PackedCard, 52> &deck);
+int play_higher_lower_with_jokers (Strategy strategy, const std::array<PackedCard, 54> &deck);
+}
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <barrier>
+#include <thread>
+
+#include "solver.h"
+
+namespace
+{
+// A card is showing, so at most 51 cards are unseen; with a Joker showing it could be all 52
+constexpr int max_cards_left = 51;
+constexpr int layer_width    = max_cards_left + 2;
+constexpr int triangle       = (max_cards_left + 1) * (max_cards_left + 2) / 2;
+}
+
+std::size_t
+cards::HigherLowerSolver::card_slot (int cards_left, int below, int jokers_left) const
+{
+  return static_cast<std::size_t> (jokers_left * triangle + cards_left * (cards_left + 1) / 2 + below);
+}
+
+std::size_t
+cards::HigherLowerSolver::joker_slot (int cards_left, int jokers_left) const
+{
+  return static_cast<std::size_t> (jokers_left * layer_width + cards_left);
+}
+
+// With a card showing: if the next is a Joker any guess is right, otherwise the next card is equally likely
+// to be any of the cards_left, and the guess is right for those above (h) or below (l) the one showing
+void
+cards::HigherLowerSolver::fill_layer (int cards_left, int jokers_left, int first, int last)
+{
+  const int     total = cards_left + jokers_left;
+  const double  joker_next
+      = jokers_left ? jokers_left * (1 + joker_showing_[joker_slot (cards_left, jokers_left - 1)]) : 0.0;
+  const double *beneath = cards_left ? &prefix_[joker_slot (cards_left - 1, jokers_left) * layer_width] : nullptr;
+  for (int below = first; below < last; ++below)
+    {
+      double value = 0.0;
+      if (total)
+        {
+          const double lower  = beneath ? beneath[below] : 0.0;
+          const double higher = beneath ? beneath[cards_left] - lower : 0.0;
+          value               = (joker_next + std::max (lower, higher)) / total;
+        }
+      card_showing_[card_slot (cards_left, below, jokers_left)] = value;
+    }
+}
+
+// With a Joker showing any guess is right, whatever comes next
+void
+cards::HigherLowerSolver::fill_after_joker (int cards_left, int jokers_left)
+{
+  const int total = cards_left + jokers_left;
+  double    sum   = 0.0;
+  if (jokers_left)
+    {
+      sum += jokers_left * (1 + joker_showing_[joker_slot (cards_left, jokers_left - 1)]);
+    }
+  if (cards_left)
+    {
+      sum += prefix_[joker_slot (cards_left - 1, jokers_left) * layer_width + cards_left];
+    }
+  joker_showing_[joker_slot (cards_left, jokers_left)] = total ? sum / total : 0.0;
+}
+
+cards::HigherLowerSolver::HigherLowerSolver (int jokers, unsigned threads)
+    : jokers_ (jokers), card_showing_ (static_cast<std::size_t> ((jokers + 1) * triangle)),
+      joker_showing_ (static_cast<std::size_t> ((jokers + 1) * layer_width)),
+      prefix_ (static_cast<std::size_t> ((jokers + 1) * layer_width * layer_width))
+{
+  if (threads == 0)
+    {
+      threads = std::max (1u, std::thread::hardware_concurrency ());
+    }
+
+  int jokers_left = 0;
+  int cards_left  = 0;
+  fill_after_joker (0, 0);
+
+  // Once every thread has filled its share of a layer, one of them sums it up and moves everyone on
+  auto layer_done = [&] () noexcept {
+    double *prefix = &prefix_[joker_slot (cards_left, jokers_left) * layer_width];
+    prefix[0]      = 0.0;
+    for (int below = 0; below <= cards_left; ++below)
+      {
+        prefix[below + 1] = prefix[below] + 1 + card_showing_[card_slot (cards_left, below, jokers_left)];
+      }
+    fill_after_joker (cards_left + 1, jokers_left);
+    if (++cards_left > max_cards_left)
+      {
+        cards_left = 0;
+        ++jokers_left;
+        if (jokers_left <= jokers_)
+          {
+            fill_after_joker (0, jokers_left);
+          }
+      }
+  };
+
+  std::barrier sync (static_cast<std::ptrdiff_t> (threads), layer_done);
+  {
+    std::vector<std::jthread> workers;
+    for (unsigned self = 0; self < threads; ++self)
+      {
+        workers.emplace_back ([&, self] () {
+          while (jokers_left <= jokers_)
+            {
+              const int width = cards_left + 1;
+              fill_layer (cards_left, jokers_left, static_cast<int> (width * self / threads),
+                          static_cast<int> (width * (self + 1) / threads));
+              sync.arrive_and_wait ();
+            }
+        });
+      }
+  }
+}
+
+double
+cards::HigherLowerSolver::expected_score () const
+{
+  const int cards = max_cards_left + 1;
+  double    sum   = jokers_ ? jokers_ * joker_showing_[joker_slot (cards, jokers_ - 1)] : 0.0;
+  for (int below = 0; below < cards; ++below)
+    {
+      sum += card_showing_[card_slot (max_cards_left, below, jokers_)];
+    }
+  return sum / (cards + jokers_);
+}
+
+double
+cards::HigherLowerSolver::expected_score (int below, int above, int jokers_left) const
+{
+  return card_showing_[card_slot (below + above, below, jokers_left)];
+}
+
+double
+cards::HigherLowerSolver::expected_score_after_joker (int cards_left, int jokers_left) const
+{
+  return joker_showing_[joker_slot (cards_left, jokers_left)];
+}
+
+char
+cards::HigherLowerSolver::best_guess (int below, int above, int jokers_left) const
+{
+  const int cards_left = below + above;
+  if (cards_left == 0)
+    {
+      return 'h';
+    }
+  const double *beneath = &prefix_[joker_slot (cards_left - 1, jokers_left) * layer_width];
+  return beneath[cards_left] - beneath[below] >= beneath[below] ? 'h' : 'l';
+}
+
+char
+cards::HigherLowerSolver::best_guess (PackedCard current, CardSet seen, int jokers_left) const
+{
+  const CardSet unseen = CardSet::full_deck () - seen;
+  return best_guess (unseen.below (current).size (), unseen.above (current).size (), jokers_left);
+}
+
+char
+cards::play_optimally (PackedCard current, CardSet seen)
+{
+  static const HigherLowerSolver solver;
+  return solver.best_guess (current, seen);
+}
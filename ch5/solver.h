@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+#include "card_set.h"
+
+namespace cards
+{
+// Exact expected score for higher_lower (aces low, is_guess_correct semantics) under optimal play,
+// optionally with Jokers as free goes.
+//
+// Card's operator<=> orders all 52 cards strictly, so once a card is showing only the counts of unseen
+// cards below and above it matter: the next card is equally likely to be any of them, and its own
+// below/above counts follow from where it falls. The memo is therefore keyed on (cards left, cards below,
+// Jokers left) rather than on which cards are left, and each layer of cards left is filled in parallel
+// from the layer beneath it.
+class HigherLowerSolver
+{
+public:
+  explicit HigherLowerSolver (int jokers = 0, unsigned threads = 0);
+
+  // Expected score before the first card is turned over
+  double expected_score () const;
+
+  // Expected score from here on with a card showing, and below + above cards and jokers_left Jokers unseen
+  double expected_score (int below, int above, int jokers_left = 0) const;
+  // Expected score from here on with a Joker showing
+  double expected_score_after_joker (int cards_left, int jokers_left) const;
+
+  char best_guess (int below, int above, int jokers_left = 0) const;
+  char best_guess (PackedCard current, CardSet seen, int jokers_left = 0) const;
+
+private:
+  std::size_t card_slot (int cards_left, int below, int jokers_left) const;
+  std::size_t joker_slot (int cards_left, int jokers_left) const;
+  void        fill_layer (int cards_left, int jokers_left, int first, int last);
+  void        fill_after_joker (int cards_left, int jokers_left);
+
+  int                 jokers_;
+  std::vector<double> card_showing_;
+  std::vector<double> joker_showing_;
+  // For each layer, prefix sums over below of (1 + value), so a guess is scored in constant time
+  std::vector<double> prefix_;
+};
+
+// A Strategy for simulate: the solver's best guess for the game without Jokers
+char play_optimally (PackedCard current, CardSet seen);
+}
@@ -0,0 +1,45 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "table_service.h"
+
+// Either serve tables on a local socket until stdin closes:
+//   table_load --serve <socket path> [tables]
+// or drive them with synthetic clients and report throughput and latency:
+//   table_load [tables] [clients] [seconds]
+int
+main (int argc, char *argv[])
+{
+  using namespace cards;
+  using namespace std::chrono;
+
+  if (argc > 2 && std::string (argv[1]) == "--serve")
+    {
+      TableService      service (argc > 3 ? std::stoul (argv[3]) : 10'000);
+      std::atomic<bool> stop{};
+      std::jthread      server ([&] () { serve (service, argv[2], stop); });
+      std::cout << "Serving " << service.tables () << " tables on " << argv[2] << "; close stdin to stop\n";
+      std::string line;
+      while (std::getline (std::cin, line))
+        {
+        }
+      stop = true;
+      return 0;
+    }
+
+  const std::size_t tables  = argc > 1 ? std::stoul (argv[1]) : 10'000;
+  const unsigned    clients = argc > 2 ? static_cast<unsigned> (std::stoul (argv[2])) : 4;
+  const auto        length  = duration_cast<milliseconds> (duration<double> (argc > 3 ? std::stod (argv[3]) : 2.0));
+
+  TableService service (tables);
+  auto         report = generate_load (service, clients, length);
+  service.stop ();
+  auto queued = service.latencies ();
+  std::cout << tables << " tables, " << clients << " clients: " << report.turns << " turns in " << report.seconds
+            << "s = " << report.turns / report.seconds << " turns/s\n"
+            << "round trip p50 " << report.p50.count () << "ns, p99 " << report.p99.count () << "ns, p99.9 "
+            << report.p999.count () << "ns\n"
+            << "queue to played p50 " << queued.percentile (50).count () << "ns, p99 "
+            << queued.percentile (99).count () << "ns, p99.9 " << queued.percentile (99.9).count () << "ns\n";
+}
@@ -0,0 +1,530 @@
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+#include <string_view>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "shuffler.h"
+#include "table_service.h"
+
+namespace
+{
+using namespace cards;
+
+constexpr std::size_t queue_capacity = 1 << 14;
+constexpr int         spins          = 256;
+
+std::size_t
+bucket_for (std::uint64_t ns)
+{
+  if (ns < 16)
+    {
+      return static_cast<std::size_t> (ns);
+    }
+  const int exponent = std::bit_width (ns) - 1;
+  return 16 + static_cast<std::size_t> (exponent - 4) * 8 + ((ns >> (exponent - 3)) & 7);
+}
+
+std::uint64_t
+bucket_floor (std::size_t bucket)
+{
+  if (bucket < 16)
+    {
+      return bucket;
+    }
+  const std::size_t exponent = (bucket - 16) / 8 + 4;
+  return (std::uint64_t{ 8 } + (bucket - 16) % 8) << (exponent - 3);
+}
+
+void
+new_game (TableSlot &slot, Shuffler &shuffler)
+{
+  shuffler.shuffle (slot.deck);
+  slot.index = 0;
+}
+
+// write may send less than it was given, so keeps going until everything is sent
+bool
+write_all (int fd, std::string_view data)
+{
+  while (!data.empty ())
+    {
+      const ssize_t sent = ::write (fd, data.data (), data.size ());
+      if (sent < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          return false;
+        }
+      data.remove_prefix (static_cast<std::size_t> (sent));
+    }
+  return true;
+}
+}
+
+void
+cards::LatencyHistogram::add (std::chrono::nanoseconds latency)
+{
+  ++buckets_[bucket_for (static_cast<std::uint64_t> (std::max<std::int64_t> (latency.count (), 0)))];
+}
+
+void
+cards::LatencyHistogram::merge (const LatencyHistogram &other)
+{
+  std::ranges::transform (buckets_, other.buckets_, buckets_.begin (), std::plus<> ());
+}
+
+std::uint64_t
+cards::LatencyHistogram::count () const
+{
+  std::uint64_t total = 0;
+  for (auto bucket : buckets_)
+    {
+      total += bucket;
+    }
+  return total;
+}
+
+std::chrono::nanoseconds
+cards::LatencyHistogram::percentile (double p) const
+{
+  const auto    target = static_cast<std::uint64_t> (p / 100.0 * count ());
+  std::uint64_t seen   = 0;
+  for (std::size_t bucket = 0; bucket < buckets_.size (); ++bucket)
+    {
+      seen += buckets_[bucket];
+      if (seen > target)
+        {
+          return std::chrono::nanoseconds (bucket_floor (bucket));
+        }
+    }
+  return std::chrono::nanoseconds (0);
+}
+
+cards::TurnQueue::TurnQueue (std::size_t capacity) : cells_ (std::bit_ceil (capacity)), mask_ (cells_.size () - 1)
+{
+  for (std::size_t i = 0; i < cells_.size (); ++i)
+    {
+      cells_[i].sequence.store (i, std::memory_order_relaxed);
+    }
+}
+
+bool
+cards::TurnQueue::push (const Turn &turn)
+{
+  std::size_t position = tail_.load (std::memory_order_relaxed);
+  for (;;)
+    {
+      Cell       &cell     = cells_[position & mask_];
+      std::size_t sequence = cell.sequence.load (std::memory_order_acquire);
+      auto        lag      = static_cast<std::ptrdiff_t> (sequence) - static_cast<std::ptrdiff_t> (position);
+      if (lag == 0)
+        {
+          if (tail_.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+            {
+              cell.turn = turn;
+              cell.sequence.store (position + 1, std::memory_order_release);
+              return true;
+            }
+        }
+      else if (lag < 0)
+        {
+          return false;
+        }
+      else
+        {
+          position = tail_.load (std::memory_order_relaxed);
+        }
+    }
+}
+
+bool
+cards::TurnQueue::pop (Turn &turn)
+{
+  std::size_t position = head_.load (std::memory_order_relaxed);
+  for (;;)
+    {
+      Cell       &cell     = cells_[position & mask_];
+      std::size_t sequence = cell.sequence.load (std::memory_order_acquire);
+      auto        lag      = static_cast<std::ptrdiff_t> (sequence) - static_cast<std::ptrdiff_t> (position + 1);
+      if (lag == 0)
+        {
+          if (head_.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+            {
+              turn = cell.turn;
+              cell.sequence.store (position + mask_ + 1, std::memory_order_release);
+              return true;
+            }
+        }
+      else if (lag < 0)
+        {
+          return false;
+        }
+      else
+        {
+          position = head_.load (std::memory_order_relaxed);
+        }
+    }
+}
+
+cards::TableService::TableService (std::size_t tables, unsigned workers, std::uint64_t seed) : tables_ (tables)
+{
+  if (workers == 0)
+    {
+      workers = std::max (1u, std::thread::hardware_concurrency ());
+    }
+  for (unsigned i = 0; i < workers; ++i)
+    {
+      workers_.push_back (std::make_unique<Worker> (queue_capacity));
+      workers_.back ()->slots.resize ((tables + workers - 1 - i) / workers);
+    }
+  for (unsigned i = 0; i < workers; ++i)
+    {
+      Worker &worker = *workers_[i];
+      worker.thread  = std::jthread ([this, &worker, seed, i] () { run (worker, seed ^ (i * 0x9E3779B97F4A7C15)); });
+    }
+}
+
+cards::TableService::~TableService ()
+{
+  stop ();
+}
+
+void
+cards::TableService::run (Worker &worker, std::uint64_t seed)
+{
+  Shuffler shuffler (seed);
+  std::array<PackedCard, 52> fresh;
+  std::ranges::copy (CardSet::full_deck (), fresh.begin ());
+  for (auto &slot : worker.slots)
+    {
+      slot.deck = fresh;
+      new_game (slot, shuffler);
+    }
+
+  const auto workers = static_cast<std::uint32_t> (workers_.size ());
+  Turn       turn;
+  int        idle_spins = 0;
+  for (;;)
+    {
+      // Once closed, whatever is still queued is played before leaving, so no reply is left waiting
+      const bool closed = closed_.load (std::memory_order_acquire);
+      if (!worker.queue.pop (turn))
+        {
+          if (closed)
+            {
+              return;
+            }
+          if (++idle_spins < spins)
+            {
+              std::this_thread::yield ();
+              continue;
+            }
+          // Announce we are going to sleep, then look once more so a turn pushed meanwhile is not missed
+          const std::uint32_t seen = worker.wakeups.load ();
+          worker.idle.store (true);
+          std::atomic_thread_fence (std::memory_order_seq_cst);
+          if (!worker.queue.pop (turn))
+            {
+              if (!closed_.load ())
+                {
+                  worker.wakeups.wait (seen);
+                }
+              worker.idle.store (false);
+              continue;
+            }
+          worker.idle.store (false);
+        }
+      idle_spins = 0;
+
+      TableSlot       &slot    = worker.slots[turn.table / workers];
+      const PackedCard current = slot.deck[slot.index];
+      TurnResult       result{ false, false, slot.index, current };
+      if (turn.guess == 'h' || turn.guess == 'l')
+        {
+          const PackedCard next = slot.deck[slot.index + 1];
+          result.correct        = is_guess_correct (turn.guess, current, next);
+          result.showing        = next;
+          if (result.correct)
+            {
+              result.score = ++slot.index;
+            }
+          if (!result.correct || slot.index + 1u == slot.deck.size ())
+            {
+              result.game_over = true;
+              slot.best        = std::max<std::uint32_t> (slot.best, slot.index);
+              ++slot.games;
+              new_game (slot, shuffler);
+            }
+        }
+      ++worker.turns;
+      worker.latencies.add (std::chrono::steady_clock::now () - turn.submitted);
+      if (turn.reply)
+        {
+          turn.reply->result = result;
+          turn.reply->ready.store (true, std::memory_order_release);
+          turn.reply->ready.notify_one ();
+        }
+    }
+}
+
+bool
+cards::TableService::submit (std::uint32_t table, char guess, Reply *reply)
+{
+  if (table >= tables_)
+    {
+      throw std::out_of_range ("No such table");
+    }
+  // Counted in before looking at stopping_, so stop can wait for any push already past the check
+  submitting_.fetch_add (1);
+  if (stopping_.load ())
+    {
+      submitting_.fetch_sub (1);
+      throw std::runtime_error ("Table service is stopping");
+    }
+  Worker &worker = *workers_[table % workers_.size ()];
+  if (reply)
+    {
+      reply->ready.store (false, std::memory_order_relaxed);
+    }
+  const bool pushed = worker.queue.push (Turn{ table, guess, reply, std::chrono::steady_clock::now () });
+  submitting_.fetch_sub (1, std::memory_order_release);
+  if (!pushed)
+    {
+      return false;
+    }
+  std::atomic_thread_fence (std::memory_order_seq_cst);
+  if (worker.idle.load () && worker.idle.exchange (false))
+    {
+      worker.wakeups.fetch_add (1);
+      worker.wakeups.notify_one ();
+    }
+  return true;
+}
+
+cards::TurnResult
+cards::TableService::play (std::uint32_t table, char guess)
+{
+  Reply reply;
+  while (!submit (table, guess, &reply))
+    {
+      std::this_thread::yield ();
+    }
+  return reply.wait ();
+}
+
+void
+cards::TableService::stop ()
+{
+  if (stopping_.exchange (true))
+    {
+      return;
+    }
+  while (submitting_.load (std::memory_order_acquire) != 0)
+    {
+      std::this_thread::yield ();
+    }
+  closed_.store (true, std::memory_order_release);
+  for (auto &worker : workers_)
+    {
+      worker->wakeups.fetch_add (1);
+      worker->wakeups.notify_all ();
+    }
+  for (auto &worker : workers_)
+    {
+      worker->thread.join ();
+    }
+}
+
+std::uint64_t
+cards::TableService::turns () const
+{
+  std::uint64_t total = 0;
+  for (const auto &worker : workers_)
+    {
+      total += worker->turns;
+    }
+  return total;
+}
+
+cards::LatencyHistogram
+cards::TableService::latencies () const
+{
+  LatencyHistogram total;
+  for (const auto &worker : workers_)
+    {
+      total.merge (worker->latencies);
+    }
+  return total;
+}
+
+void
+cards::serve (TableService &service, const std::string &socket_path, const std::atomic<bool> &stop)
+{
+  const int listener = ::socket (AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0)
+    {
+      throw std::runtime_error ("Failed to create socket");
+    }
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socket_path.size () >= sizeof (address.sun_path))
+    {
+      ::close (listener);
+      throw std::invalid_argument ("Socket path too long");
+    }
+  std::ranges::copy (socket_path, address.sun_path);
+  ::unlink (socket_path.c_str ());
+  if (::bind (listener, reinterpret_cast<sockaddr *> (&address), sizeof (address)) != 0 || ::listen (listener, 64) != 0)
+    {
+      ::close (listener);
+      throw std::runtime_error ("Failed to listen on " + socket_path);
+    }
+
+  std::vector<std::jthread> connections;
+  while (!stop)
+    {
+      pollfd waiting{ listener, POLLIN, 0 };
+      if (::poll (&waiting, 1, 100) <= 0)
+        {
+          continue;
+        }
+      const int client = ::accept (listener, nullptr, nullptr);
+      if (client < 0)
+        {
+          continue;
+        }
+      connections.emplace_back ([&service, &stop, client] () {
+        std::string pending;
+        char        buffer[4096];
+        while (!stop)
+          {
+            pollfd readable{ client, POLLIN, 0 };
+            if (::poll (&readable, 1, 100) <= 0)
+              {
+                continue;
+              }
+            const ssize_t got = ::read (client, buffer, sizeof (buffer));
+            if (got <= 0)
+              {
+                break;
+              }
+            pending.append (buffer, static_cast<std::size_t> (got));
+            std::string replies;
+            for (auto end = pending.find ('\n'); end != std::string::npos; end = pending.find ('\n'))
+              {
+                unsigned long table = 0;
+                char          guess = '?';
+                TurnResult    result;
+                bool          answered = false;
+                // Only this line: %c skips the newline, so would take a missing guess from the next one
+                const std::string line (pending, 0, end);
+                if (std::sscanf (line.c_str (), "%lu %c", &table, &guess) >= 1 && table < service.tables ())
+                  {
+                    try
+                      {
+                        result   = service.play (static_cast<std::uint32_t> (table), guess);
+                        answered = true;
+                      }
+                    catch (const std::runtime_error &)
+                      {
+                        // The service stopped before the server did
+                      }
+                  }
+                if (answered)
+                  {
+                    const bool played = guess == 'h' || guess == 'l';
+                    replies += (played ? (result.correct ? "correct " : "wrong ") : "showing ")
+                               + std::to_string (result.score) + ' '
+                               + std::to_string (result.showing.face_value ()) + ' '
+                               + std::to_string (static_cast<int> (result.showing.suit ())) + '\n';
+                  }
+                else
+                  {
+                    replies += "error\n";
+                  }
+                pending.erase (0, end + 1);
+              }
+            if (!write_all (client, replies))
+              {
+                break;
+              }
+          }
+        ::close (client);
+      });
+    }
+  connections.clear ();
+  ::close (listener);
+  ::unlink (socket_path.c_str ());
+}
+
+cards::LoadReport
+cards::generate_load (TableService &service, unsigned clients, std::chrono::milliseconds duration, unsigned in_flight)
+{
+  std::vector<LatencyHistogram> latencies (clients);
+  std::vector<std::uint64_t>    turns (clients);
+  const auto                    start = std::chrono::steady_clock::now ();
+  const auto                    until = start + duration;
+  {
+    std::vector<std::jthread> threads;
+    for (unsigned client = 0; client < clients; ++client)
+      {
+        threads.emplace_back ([&, client] () {
+          Shuffler                                           random (client + 1);
+          std::vector<Reply>                                 replies (in_flight);
+          std::vector<std::chrono::steady_clock::time_point> sent (in_flight);
+          LatencyHistogram                                   local;
+          std::uint64_t                                      done = 0;
+          auto send = [&] (std::size_t i) {
+            const auto table = random.bounded (static_cast<std::uint32_t> (service.tables ()));
+            sent[i]          = std::chrono::steady_clock::now ();
+            while (!service.submit (table, random.bounded (2) ? 'h' : 'l', &replies[i]))
+              {
+                std::this_thread::yield ();
+              }
+          };
+          for (std::size_t i = 0; i < replies.size (); ++i)
+            {
+              send (i);
+            }
+          while (std::chrono::steady_clock::now () < until)
+            {
+              for (std::size_t i = 0; i < replies.size (); ++i)
+                {
+                  replies[i].wait ();
+                  local.add (std::chrono::steady_clock::now () - sent[i]);
+                  ++done;
+                  send (i);
+                }
+            }
+          for (auto &reply : replies)
+            {
+              reply.wait ();
+            }
+          latencies[client] = local;
+          turns[client]     = done;
+        });
+      }
+  }
+
+  LoadReport       report;
+  LatencyHistogram total;
+  for (unsigned client = 0; client < clients; ++client)
+    {
+      total.merge (latencies[client]);
+      report.turns += turns[client];
+    }
+  report.seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  report.p50     = total.percentile (50);
+  report.p99     = total.percentile (99);
+  report.p999    = total.percentile (99.9);
+  return report;
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "card_set.h"
+
+namespace cards
+{
+// One higher/lower table in one cache line, so neighbouring tables never share a line
+struct alignas (64) TableSlot
+{
+  std::array<PackedCard, 52> deck;
+  std::uint8_t               index{};
+  std::uint32_t              games{};
+  std::uint32_t              best{};
+};
+
+static_assert (sizeof (TableSlot) == 64);
+
+struct TurnResult
+{
+  bool       correct{};
+  bool       game_over{};
+  int        score{};  // index, as in higher_lower
+  PackedCard showing; // the card turned over, or the one showing if no guess was made
+};
+
+// Filled in by the table's worker; wait () blocks until it is
+struct Reply
+{
+  TurnResult        result;
+  std::atomic<bool> ready{};
+
+  TurnResult
+  wait ()
+  {
+    ready.wait (false, std::memory_order_acquire);
+    return result;
+  }
+};
+
+// Counts of nanosecond latencies in log-linear buckets, eight per power of two
+class LatencyHistogram
+{
+public:
+  void                     add (std::chrono::nanoseconds latency);
+  void                     merge (const LatencyHistogram &other);
+  std::uint64_t            count () const;
+  std::chrono::nanoseconds percentile (double p) const;
+
+private:
+  std::array<std::uint64_t, 512> buckets_{};
+};
+
+// A bounded lock-free queue of turns (Vyukov's array based queue)
+struct Turn
+{
+  std::uint32_t                         table{};
+  char                                  guess{};
+  Reply                                *reply{};
+  std::chrono::steady_clock::time_point submitted;
+};
+
+class TurnQueue
+{
+public:
+  explicit TurnQueue (std::size_t capacity);
+
+  bool push (const Turn &turn);
+  bool pop (Turn &turn);
+
+private:
+  struct Cell
+  {
+    std::atomic<std::size_t> sequence;
+    Turn                     turn;
+  };
+
+  std::vector<Cell>                     cells_;
+  std::size_t                           mask_;
+  alignas (64) std::atomic<std::size_t> tail_{};
+  alignas (64) std::atomic<std::size_t> head_{};
+};
+
+// Runs many independent higher/lower tables. Tables are split between workers, one per core by default,
+// and only a table's own worker ever touches its slot; turns reach the worker through its own queue.
+// A guess of 'h' or 'l' plays a turn, anything else just reports the card showing.
+class TableService
+{
+public:
+  explicit TableService (std::size_t tables, unsigned workers = 0, std::uint64_t seed = 0);
+  ~TableService ();
+  TableService (const TableService &)            = delete;
+  TableService &operator= (const TableService &) = delete;
+
+  std::size_t
+  tables () const
+  {
+    return tables_;
+  }
+
+  // False if the table's queue is full; the reply, if any, must live until it is ready.
+  // Both throw std::runtime_error once the service is stopping.
+  bool       submit (std::uint32_t table, char guess, Reply *reply = nullptr);
+  TurnResult play (std::uint32_t table, char guess);
+
+  // Refuses new turns, plays those already queued, then stops the workers;
+  // every reply is ready and the statistics are complete once this returns
+  void             stop ();
+  std::uint64_t    turns () const;
+  LatencyHistogram latencies () const; // from submission until the worker has played the turn
+
+private:
+  struct alignas (64) Worker
+  {
+    explicit Worker (std::size_t capacity) : queue (capacity) {}
+
+    TurnQueue                  queue;
+    std::vector<TableSlot>     slots;
+    LatencyHistogram           latencies;
+    std::uint64_t              turns{};
+    alignas (64) std::atomic<bool> idle{};
+    std::atomic<std::uint32_t> wakeups{};
+    std::jthread               thread;
+  };
+
+  void run (Worker &worker, std::uint64_t seed);
+
+  std::size_t                            tables_;
+  std::vector<std::unique_ptr<Worker> >  workers_;
+  std::atomic<bool>                      stopping_{};   // submit refuses turns
+  std::atomic<unsigned>                  submitting_{}; // calls to submit which may still push
+  std::atomic<bool>                      closed_{};     // nothing more will be pushed; workers drain and leave
+};
+
+// A line based front end on a local (Unix domain) socket: each line "<table> <guess>" gets back
+// "<correct|wrong|showing> <score> <face value> <suit>". After a game ends the table is dealt afresh,
+// so ask with a guess of '?' to see the new first card. Runs until stop is set.
+void serve (TableService &service, const std::string &socket_path, const std::atomic<bool> &stop);
+
+struct LoadReport
+{
+  std::uint64_t            turns{};
+  double                   seconds{};
+  std::chrono::nanoseconds p50{}, p99{}, p999{};
+};
+
+// Synthetic clients, each keeping a window of turns in flight at random tables
+LoadReport generate_load (TableService &service, unsigned clients, std::chrono::milliseconds duration,
+                          unsigned in_flight = 16);
+}
@@ -0,0 +1,59 @@
+#include <chrono>
+#include <iostream>
+#include <ranges>
+#include <thread>
+
+#include "BlobArena.h"
+
+Race::BlobArena::BlobArena (std::size_t bytes, std::size_t blobs)
+    : resource (bytes > 0 ? bytes : 1024, std::pmr::new_delete_resource ())
+{
+  handles.reserve (blobs);
+}
+
+// The blobs still need destroying, but not freeing one by one
+Race::BlobArena::~BlobArena ()
+{
+  for (auto &blob : handles | std::views::reverse)
+    {
+      blob->~Blob ();
+    }
+}
+
+// Listing 6.15, through handles
+void
+Race::race (std::vector<BlobHandle> &blobs)
+{
+  using namespace std::chrono;
+  const int max = 3;
+  std::cout << "\x1B[2J\x1B[H";
+  for (int i = 0; i < max; ++i)
+    {
+      draw_blobs (blobs);
+      move_blobs (blobs);
+      std::this_thread::sleep_for (1000ms);
+      std::cout << "\x1B[2J\x1B[H";
+    }
+  draw_blobs (blobs);
+}
+
+void
+Race::move_blobs (std::vector<BlobHandle> &blobs)
+{
+  for (auto &blob : blobs)
+    {
+      blob->step ();
+    }
+}
+
+void
+Race::draw_blobs (const std::vector<BlobHandle> &blobs)
+{
+  std::vector<int> positions;
+  positions.reserve (blobs.size ());
+  for (const auto &blob : blobs)
+    {
+      positions.push_back (blob->total_steps ());
+    }
+  draw_blobs (positions);
+}
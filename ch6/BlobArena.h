@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "Race.h"
+
+namespace Race
+{
+// Points at a blob owned by something else, such as a BlobArena; copying one never copies or frees the blob
+class BlobHandle
+{
+  Blob *blob;
+
+public:
+  explicit BlobHandle (Blob &blob) : blob (&blob) {}
+
+  Blob &
+  operator* () const
+  {
+    return *blob;
+  }
+  Blob *
+  operator->() const
+  {
+    return blob;
+  }
+};
+
+// Every blob of a race carved, one after another, out of a monotonic buffer:
+// creating one is a pointer bump, and the memory all goes back at once when the arena goes.
+class BlobArena
+{
+  std::pmr::monotonic_buffer_resource resource;
+  std::vector<BlobHandle>             handles;
+
+public:
+  // Reserving room for the blobs expected saves growing the buffer in chunks
+  explicit BlobArena (std::size_t bytes = 0, std::size_t blobs = 0);
+  ~BlobArena ();
+  BlobArena (const BlobArena &)            = delete;
+  BlobArena &operator= (const BlobArena &) = delete;
+
+  template <typename T, typename... Args>
+  T &
+  create (Args &&...args)
+  {
+    void *memory = resource.allocate (sizeof (T), alignof (T));
+    T    *blob   = new (memory) T (std::forward<Args> (args)...);
+    handles.emplace_back (*blob);
+    return *blob;
+  }
+
+  // In the order created
+  std::vector<BlobHandle> &
+  blobs ()
+  {
+    return handles;
+  }
+  const std::vector<BlobHandle> &
+  blobs () const
+  {
+    return handles;
+  }
+};
+
+void race (std::vector<BlobHandle> &blobs);
+void move_blobs (std::vector<BlobHandle> &blobs);
+void draw_blobs (const std::vector<BlobHandle> &blobs);
+}
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "BlobEngine.h"
+
+namespace
+{
+std::uint64_t
+splitmix64 (std::uint64_t &x)
+{
+  std::uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+  z               = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z               = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// Only shifts and xors, so the loop over a group's states vectorizes
+void
+advance (std::vector<std::uint32_t> &state)
+{
+  for (auto &x : state)
+    {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+    }
+}
+}
+
+std::vector<std::uint32_t>
+Race::poisson_thresholds (double mean)
+{
+  // exp (-mean) underflows a double beyond this
+  if (!(mean > 0.0) || mean > 700.0)
+    {
+      throw std::invalid_argument ("Poisson mean must be in (0, 700]");
+    }
+  const double               scale = 4294967296.0;
+  std::vector<std::uint32_t> thresholds;
+  double                     probability = std::exp (-mean);
+  double                     cumulative  = probability;
+  // Far enough into the tail that the remaining probability rounds away
+  const double               last = mean + 40.0 * std::sqrt (mean) + 40.0;
+  for (int k = 1; cumulative * scale < scale - 1.0 && k < last; ++k)
+    {
+      thresholds.push_back (static_cast<std::uint32_t> (cumulative * scale));
+      probability *= mean / k;
+      cumulative += probability;
+    }
+  return thresholds;
+}
+
+Race::BlobEngine::BlobEngine (std::uint64_t seed) : seed (seed) {}
+
+std::uint32_t
+Race::BlobEngine::next_state ()
+{
+  std::uint32_t state = 0;
+  while (state == 0) // xorshift never leaves zero
+    {
+      state = static_cast<std::uint32_t> (splitmix64 (seed));
+    }
+  return state;
+}
+
+std::size_t
+Race::BlobEngine::add_steppers (std::size_t count, int step_size)
+{
+  const std::size_t first = blobs.size ();
+  auto              group
+      = std::find_if (steppers.begin (), steppers.end (), [&] (const auto &g) { return g.step_size == step_size; });
+  if (group == steppers.end ())
+    {
+      group = steppers.insert (steppers.end (), StepperGroup{ step_size, {} });
+    }
+  const auto group_id = static_cast<std::uint32_t> (group - steppers.begin ());
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      blobs.push_back ({ Kind::stepper, group_id, static_cast<std::uint32_t> (group->y.size ()) });
+      group->y.push_back (0);
+    }
+  return first;
+}
+
+std::size_t
+Race::BlobEngine::add_uniform (std::size_t count, int min, int max)
+{
+  if (max < min)
+    {
+      throw std::invalid_argument ("Uniform blob needs min <= max");
+    }
+  const std::size_t   first = blobs.size ();
+  const std::uint32_t range = static_cast<std::uint32_t> (static_cast<std::int64_t> (max) - min + 1);
+  auto                group = std::find_if (uniforms.begin (), uniforms.end (),
+                                          [&] (const auto &g) { return g.min == min && g.range == range; });
+  if (group == uniforms.end ())
+    {
+      group = uniforms.insert (uniforms.end (), UniformGroup{ min, range, {}, {} });
+    }
+  const auto group_id = static_cast<std::uint32_t> (group - uniforms.begin ());
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      blobs.push_back ({ Kind::uniform, group_id, static_cast<std::uint32_t> (group->y.size ()) });
+      group->y.push_back (0);
+      group->state.push_back (next_state ());
+    }
+  return first;
+}
+
+std::size_t
+Race::BlobEngine::add_poisson (std::size_t count, double mean)
+{
+  const std::size_t first = blobs.size ();
+  auto group = std::find_if (poissons.begin (), poissons.end (), [&] (const auto &g) { return g.mean == mean; });
+  if (group == poissons.end ())
+    {
+      group = poissons.insert (poissons.end (), PoissonGroup{ mean, poisson_thresholds (mean), {}, {} });
+    }
+  const auto group_id = static_cast<std::uint32_t> (group - poissons.begin ());
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      blobs.push_back ({ Kind::poisson, group_id, static_cast<std::uint32_t> (group->y.size ()) });
+      group->y.push_back (0);
+      group->state.push_back (next_state ());
+    }
+  return first;
+}
+
+void
+Race::BlobEngine::step ()
+{
+  for (auto &group : steppers)
+    {
+      for (auto &y : group.y)
+        {
+          y += group.step_size;
+        }
+    }
+
+  for (auto &group : uniforms)
+    {
+      advance (group.state);
+      const std::size_t    n     = group.y.size ();
+      int *const           y     = group.y.data ();
+      const std::uint32_t *state = group.state.data ();
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          // Multiply and shift maps the draw onto [0, range)
+          y[i] += group.min + static_cast<int> ((static_cast<std::uint64_t> (state[i]) * group.range) >> 32);
+        }
+    }
+
+  // Threshold by threshold, so the inner loop runs over the blobs, a cache sized block at a time
+  const std::size_t block = 2048;
+  for (auto &group : poissons)
+    {
+      advance (group.state);
+      const std::size_t n = group.y.size ();
+      for (std::size_t start = 0; start < n; start += block)
+        {
+          const std::size_t    end   = std::min (n, start + block);
+          int *const           y     = group.y.data ();
+          const std::uint32_t *state = group.state.data ();
+          for (const std::uint32_t threshold : group.thresholds)
+            {
+              for (std::size_t i = start; i < end; ++i)
+                {
+                  y[i] += state[i] >= threshold;
+                }
+            }
+        }
+    }
+}
+
+int
+Race::BlobEngine::total_steps (std::size_t id) const
+{
+  const Location &blob = blobs.at (id);
+  switch (blob.kind)
+    {
+    case Kind::stepper:
+      return steppers[blob.group].y[blob.index];
+    case Kind::uniform:
+      return uniforms[blob.group].y[blob.index];
+    case Kind::poisson:
+      return poissons[blob.group].y[blob.index];
+    }
+  return 0;
+}
+
+std::vector<int>
+Race::BlobEngine::total_steps () const
+{
+  std::vector<int> positions;
+  positions.reserve (blobs.size ());
+  for (std::size_t id = 0; id < blobs.size (); ++id)
+    {
+      positions.push_back (total_steps (id));
+    }
+  return positions;
+}
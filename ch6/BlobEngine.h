@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Race
+{
+// Cumulative Poisson probabilities scaled to 2^32: a uniform 32-bit draw at or above exactly k of them
+// is a step of k
+std::vector<std::uint32_t> poisson_thresholds (double mean);
+
+// Blobs grouped by kind, each group held as a structure of arrays, so a tick is a few tight loops
+// over contiguous ints rather than a virtual call per blob through a pointer.
+// Steppers behave like StepperBlob; uniform and Poisson blobs like RandomBlob with
+// uniform_int_distribution and poisson_distribution, each blob with its own xorshift32 generator.
+class BlobEngine
+{
+  struct StepperGroup
+  {
+    int              step_size;
+    std::vector<int> y;
+  };
+
+  struct UniformGroup
+  {
+    int                        min;
+    std::uint32_t              range; // max - min + 1
+    std::vector<int>           y;
+    std::vector<std::uint32_t> state;
+  };
+
+  struct PoissonGroup
+  {
+    double                     mean;
+    std::vector<std::uint32_t> thresholds;
+    std::vector<int>           y;
+    std::vector<std::uint32_t> state;
+  };
+
+  enum class Kind : std::uint8_t
+  {
+    stepper,
+    uniform,
+    poisson
+  };
+
+  struct Location
+  {
+    Kind          kind;
+    std::uint32_t group;
+    std::uint32_t index;
+  };
+
+  std::vector<StepperGroup> steppers;
+  std::vector<UniformGroup> uniforms;
+  std::vector<PoissonGroup> poissons;
+  std::vector<Location>     blobs; // in the order added
+  std::uint64_t             seed;
+
+  std::uint32_t next_state ();
+
+public:
+  explicit BlobEngine (std::uint64_t seed = 0);
+
+  // Each returns the id of the first blob added; ids count up from 0 in the order blobs are added
+  std::size_t add_steppers (std::size_t count, int step_size = 2);
+  std::size_t add_uniform (std::size_t count, int min, int max);
+  std::size_t add_poisson (std::size_t count, double mean);
+
+  // Moves every blob once
+  void step ();
+
+  std::size_t
+  size () const
+  {
+    return blobs.size ();
+  }
+  int              total_steps (std::size_t id) const;
+  std::vector<int> total_steps () const;
+};
+}
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include "GameLoop.h"
+
+namespace
+{
+using clock_type = std::chrono::steady_clock;
+using seconds    = std::chrono::duration<double>;
+
+// However far behind the simulation falls, it catches up at most this many ticks at once
+constexpr int most_ticks_per_wake = 8;
+
+// Into the buffer's existing storage, so a steady race allocates nothing
+void
+copy_positions (const std::vector<std::unique_ptr<Race::Blob> > &blobs, std::vector<int> &out)
+{
+  out.resize (blobs.size ());
+  std::transform (blobs.begin (), blobs.end (), out.begin (), [] (const auto &blob) { return blob->total_steps (); });
+}
+}
+
+Race::LoopStats
+Race::run_fixed_timestep (const std::function<void ()>                         &tick,
+                          const std::function<void (std::vector<int> &)>       &snapshot,
+                          const std::function<void (const std::vector<int> &)> &render,
+                          const LoopOptions                                    &options)
+{
+  // Anything else makes an infinite or negative tick or frame length
+  if (!(options.tick_rate > 0.0) || !(options.frame_rate > 0.0))
+    {
+      throw std::invalid_argument ("Tick and frame rates must be more than 0");
+    }
+  LoopStats                      stats;
+  TripleBuffer<std::vector<int> > states;
+  std::atomic<bool>              finished{};
+  const seconds                  tick_length (1.0 / options.tick_rate);
+  const auto                     start = clock_type::now ();
+
+  snapshot (states.back ());
+  states.publish ();
+
+  auto simulate = [&] () {
+    seconds accumulator{};
+    auto    previous = clock_type::now ();
+    while (stats.ticks < static_cast<std::uint64_t> (std::max (options.max_ticks, 0)))
+      {
+        if (options.speed <= 0.0)
+          {
+            accumulator = tick_length; // fast forward: a tick every time round
+          }
+        else
+          {
+            const auto now = clock_type::now ();
+            accumulator += (now - previous) * options.speed;
+            previous = now;
+          }
+
+        int ticked = 0;
+        while (accumulator >= tick_length && ticked < most_ticks_per_wake
+               && stats.ticks < static_cast<std::uint64_t> (options.max_ticks))
+          {
+            tick ();
+            accumulator -= tick_length;
+            ++stats.ticks;
+            ++ticked;
+          }
+        const bool done = stats.ticks == static_cast<std::uint64_t> (options.max_ticks);
+        if (ticked == most_ticks_per_wake)
+          {
+            accumulator = std::min (accumulator, tick_length); // give up on time that cannot be caught up
+          }
+        if (ticked > 0 && render)
+          {
+            snapshot (states.back ());
+            states.publish ();
+          }
+        if (!done && options.speed > 0.0 && accumulator < tick_length)
+          {
+            std::this_thread::sleep_for ((tick_length - accumulator) / options.speed);
+          }
+      }
+    finished.store (true, std::memory_order_release);
+  };
+
+  auto draw = [&] () {
+    const seconds frame_length (1.0 / options.frame_rate);
+    seconds       total{};
+    auto          due = clock_type::now ();
+    for (;;)
+      {
+        const bool last = finished.load (std::memory_order_acquire);
+        if (states.update ())
+          {
+            const auto begin = clock_type::now ();
+            render (states.front ());
+            const seconds took = clock_type::now () - begin;
+            total += took;
+            stats.worst_frame_time = std::max (stats.worst_frame_time, took);
+            ++stats.frames;
+          }
+        if (last)
+          {
+            break;
+          }
+        due += std::chrono::duration_cast<clock_type::duration> (frame_length);
+        const auto now = clock_type::now ();
+        if (now > due)
+          {
+            const auto missed = static_cast<std::uint64_t> (seconds (now - due) / frame_length);
+            stats.dropped_frames += missed;
+            due += std::chrono::duration_cast<clock_type::duration> (frame_length * static_cast<double> (missed));
+          }
+        std::this_thread::sleep_until (due);
+      }
+    if (stats.frames > 0)
+      {
+        stats.mean_frame_time = total / static_cast<double> (stats.frames);
+      }
+  };
+
+  {
+    std::jthread simulation (simulate);
+    std::jthread rendering;
+    if (render)
+      {
+        rendering = std::jthread (draw);
+      }
+  }
+  stats.elapsed = clock_type::now () - start;
+  return stats;
+}
+
+// Listing 6.15 on a fixed timestep, drawn on its own thread
+Race::LoopStats
+Race::race (std::vector<std::unique_ptr<Blob> > &blobs, TerminalRenderer &renderer, const LoopOptions &options)
+{
+  renderer.reset ();
+  return run_fixed_timestep (
+      [&] () { move_blobs (blobs); }, [&] (std::vector<int> &out) { copy_positions (blobs, out); },
+      [&] (const std::vector<int> &state) { renderer.draw (state); }, options);
+}
+
+Race::LoopStats
+Race::race (std::vector<std::unique_ptr<Blob> > &blobs, const LoopOptions &options)
+{
+  return run_fixed_timestep ([&] () { move_blobs (blobs); }, [] (std::vector<int> &) {}, {}, options);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Race.h"
+#include "Renderer.h"
+
+namespace Race
+{
+// Hands the latest value from one writer thread to one reader thread without locks or waiting.
+// The writer fills back () and publishes it; the reader's update () swaps in the newest published value,
+// skipping any it never saw.
+template <typename T> class TripleBuffer
+{
+  static constexpr std::uint8_t fresh = 4;
+
+  std::array<T, 3>          buffers{};
+  std::atomic<std::uint8_t> middle{ 1 }; // index, plus fresh if the writer has published since the last update
+  std::uint8_t              back_index  = 0;
+  std::uint8_t              front_index = 2;
+
+public:
+  T &
+  back ()
+  {
+    return buffers[back_index];
+  }
+  void
+  publish ()
+  {
+    back_index = middle.exchange (back_index | fresh, std::memory_order_acq_rel) & 3;
+  }
+
+  // True if there was something new
+  bool
+  update ()
+  {
+    if ((middle.load (std::memory_order_relaxed) & fresh) == 0)
+      {
+        return false;
+      }
+    front_index = middle.exchange (front_index, std::memory_order_acq_rel) & 3;
+    return true;
+  }
+  const T &
+  front () const
+  {
+    return buffers[front_index];
+  }
+};
+
+struct LoopOptions
+{
+  double tick_rate  = 1.0;  // simulation ticks per simulated second; must be more than 0
+  double frame_rate = 30.0; // frames drawn per real second; must be more than 0
+  double speed      = 1.0;  // simulated seconds per real second; 0 or less runs ticks as fast as possible
+  int    max_ticks  = 3;
+};
+
+struct LoopStats
+{
+  std::uint64_t                 ticks{};
+  std::uint64_t                 frames{};
+  std::uint64_t                 dropped_frames{}; // frame slots missed because drawing ran late
+  std::chrono::duration<double> elapsed{};
+  std::chrono::duration<double> mean_frame_time{};
+  std::chrono::duration<double> worst_frame_time{};
+
+  double
+  real_tick_rate () const
+  {
+    return elapsed.count () > 0.0 ? ticks / elapsed.count () : 0.0;
+  }
+};
+
+// A fixed timestep loop: real time, scaled by speed, builds up in an accumulator on the steady clock
+// and is spent one tick at a time, so the simulation steps the same way whatever the frame rate.
+// tick runs on the simulation thread, which copies each new state out with snapshot;
+// render, if given, runs on a thread of its own with the latest state. Without render it runs headless.
+// Throws std::invalid_argument if the tick rate or the frame rate is not more than 0.
+LoopStats run_fixed_timestep (const std::function<void ()>                         &tick,
+                              const std::function<void (std::vector<int> &)>       &snapshot,
+                              const std::function<void (const std::vector<int> &)> &render,
+                              const LoopOptions                                    &options);
+
+LoopStats race (std::vector<std::unique_ptr<Blob> > &blobs, TerminalRenderer &renderer, const LoopOptions &options);
+LoopStats race (std::vector<std::unique_ptr<Blob> > &blobs, const LoopOptions &options);
+}
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <barrier>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include "BlobEngine.h"
+#include "ParallelRace.h"
+
+namespace
+{
+void
+multiply (std::uint32_t a, std::uint32_t b, std::uint32_t &hi, std::uint32_t &lo)
+{
+  const std::uint64_t product = static_cast<std::uint64_t> (a) * b;
+  hi                          = static_cast<std::uint32_t> (product >> 32);
+  lo                          = static_cast<std::uint32_t> (product);
+}
+
+// Shards start on a multiple of this, so no two threads share a philox block or a cache line
+constexpr std::size_t shard_alignment = 64;
+
+struct alignas (64) Leader
+{
+  int y;
+};
+}
+
+std::array<std::uint32_t, 4>
+Race::philox (std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key)
+{
+  for (int round = 0; round < 10; ++round)
+    {
+      std::uint32_t hi0, lo0, hi1, lo1;
+      multiply (0xD2511F53u, counter[0], hi0, lo0);
+      multiply (0xCD9E8D57u, counter[2], hi1, lo1);
+      counter = { hi1 ^ counter[1] ^ key[0], lo1, hi0 ^ counter[3] ^ key[1], lo0 };
+      key[0] += 0x9E3779B9u;
+      key[1] += 0xBB67AE85u;
+    }
+  return counter;
+}
+
+Race::ParallelRace::ParallelRace (std::uint64_t seed)
+    : key{ static_cast<std::uint32_t> (seed), static_cast<std::uint32_t> (seed >> 32) }
+{
+}
+
+std::size_t
+Race::ParallelRace::add (std::size_t count, Rule new_rule)
+{
+  auto existing = std::find_if (rules.begin (), rules.end (), [&] (const Rule &r) {
+    return r.kind == new_rule.kind && r.min == new_rule.min && r.range == new_rule.range
+           && r.thresholds == new_rule.thresholds;
+  });
+  if (existing == rules.end ())
+    {
+      if (rules.size () > std::numeric_limits<std::uint16_t>::max ())
+        {
+          throw std::length_error ("Too many kinds of blob");
+        }
+      existing = rules.insert (rules.end (), std::move (new_rule));
+    }
+  const std::size_t first = y.size ();
+  rule.insert (rule.end (), count, static_cast<std::uint16_t> (existing - rules.begin ()));
+  y.insert (y.end (), count, 0);
+  return first;
+}
+
+std::size_t
+Race::ParallelRace::add_steppers (std::size_t count, int step_size)
+{
+  return add (count, { Kind::stepper, step_size, 0, {} });
+}
+
+std::size_t
+Race::ParallelRace::add_uniform (std::size_t count, int min, int max)
+{
+  if (max < min)
+    {
+      throw std::invalid_argument ("Uniform blob needs min <= max");
+    }
+  const auto range = static_cast<std::uint32_t> (static_cast<std::int64_t> (max) - min + 1);
+  return add (count, { Kind::uniform, min, range, {} });
+}
+
+std::size_t
+Race::ParallelRace::add_poisson (std::size_t count, double mean)
+{
+  return add (count, { Kind::poisson, 0, 0, poisson_thresholds (mean) });
+}
+
+// Returns the furthest any blob in the shard has gone
+int
+Race::ParallelRace::step_shard (std::size_t begin, std::size_t end, int tick_number)
+{
+  int                          furthest = std::numeric_limits<int>::min ();
+  std::array<std::uint32_t, 4> draws{};
+  for (std::size_t i = begin; i < end; ++i)
+    {
+      if (i % 4 == 0 || i == begin)
+        {
+          const std::uint64_t block = i / 4;
+          draws = philox ({ static_cast<std::uint32_t> (tick_number), static_cast<std::uint32_t> (block),
+                            static_cast<std::uint32_t> (block >> 32), 0 },
+                          key);
+        }
+      const std::uint32_t draw = draws[i % 4];
+      const Rule         &r    = rules[rule[i]];
+      switch (r.kind)
+        {
+        case Kind::stepper:
+          y[i] += r.min;
+          break;
+        case Kind::uniform:
+          y[i] += r.min + static_cast<int> ((static_cast<std::uint64_t> (draw) * r.range) >> 32);
+          break;
+        case Kind::poisson:
+          y[i] += static_cast<int> (std::upper_bound (r.thresholds.begin (), r.thresholds.end (), draw)
+                                    - r.thresholds.begin ());
+          break;
+        }
+      furthest = std::max (furthest, y[i]);
+    }
+  return furthest;
+}
+
+Race::RaceResult
+Race::ParallelRace::run (int finish_line, int max_ticks, unsigned threads)
+{
+  RaceResult result;
+  if (y.empty ())
+    {
+      result.ticks = tick;
+      return result;
+    }
+
+  if (threads == 0)
+    {
+      threads = std::max (1u, std::thread::hardware_concurrency ());
+    }
+  const std::size_t blocks = (y.size () + shard_alignment - 1) / shard_alignment;
+  threads                  = static_cast<unsigned> (std::min<std::size_t> (threads, blocks));
+
+  int                 leader    = *std::max_element (y.begin (), y.end ());
+  bool                done      = leader >= finish_line || max_ticks <= 0;
+  const int           last_tick = tick + std::max (max_ticks, 0);
+  std::vector<Leader> leaders (threads);
+
+  // Runs once per tick, after every shard has stepped and before any starts the next tick
+  auto end_tick = [&] () noexcept {
+    leader = std::ranges::max_element (leaders, {}, &Leader::y)->y;
+    ++tick;
+    done = leader >= finish_line || tick == last_tick;
+  };
+  std::barrier sync (threads, end_tick);
+
+  if (!done)
+    {
+      std::vector<std::jthread> workers;
+      for (unsigned t = 0; t < threads; ++t)
+        {
+          const std::size_t begin = std::min (y.size (), blocks * t / threads * shard_alignment);
+          const std::size_t end   = std::min (y.size (), blocks * (t + 1) / threads * shard_alignment);
+          workers.emplace_back ([&, t, begin, end] () {
+            while (!done)
+              {
+                leaders[t].y = step_shard (begin, end, tick);
+                sync.arrive_and_wait ();
+              }
+          });
+        }
+    }
+
+  result.ticks  = tick;
+  result.leader = leader;
+  for (std::size_t i = 0; i < y.size (); ++i)
+    {
+      if (y[i] == leader)
+        {
+          result.winners.push_back (i);
+        }
+    }
+  return result;
+}
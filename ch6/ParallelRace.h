@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Race
+{
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3"): a counter based
+// generator, so the numbers for a given key and counter need no state from earlier draws
+std::array<std::uint32_t, 4> philox (std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key);
+
+struct RaceResult
+{
+  int                      ticks{};
+  int                      leader{};  // furthest distance reached
+  std::vector<std::size_t> winners{}; // ids of every blob at the leader's distance
+};
+
+// Blobs stepped in lockstep ticks by several threads, each owning a contiguous shard.
+// Blob i's step in tick t comes from philox keyed by the seed, with (t, i / 4) as the counter,
+// so the race is the same, bit for bit, however many threads run it.
+class ParallelRace
+{
+  enum class Kind : std::uint8_t
+  {
+    stepper,
+    uniform,
+    poisson
+  };
+
+  struct Rule
+  {
+    Kind                       kind;
+    int                        min; // or the step size
+    std::uint32_t              range;
+    std::vector<std::uint32_t> thresholds;
+  };
+
+  std::vector<Rule>            rules;
+  std::vector<std::uint16_t>   rule; // per blob
+  std::vector<int>             y;
+  std::array<std::uint32_t, 2> key;
+  int                          tick = 0;
+
+  std::size_t add (std::size_t count, Rule new_rule);
+  int         step_shard (std::size_t begin, std::size_t end, int tick_number);
+
+public:
+  explicit ParallelRace (std::uint64_t seed = 0);
+
+  // Each returns the id of the first blob added
+  std::size_t add_steppers (std::size_t count, int step_size = 2);
+  std::size_t add_uniform (std::size_t count, int min, int max);
+  std::size_t add_poisson (std::size_t count, double mean);
+
+  // Steps every blob until one reaches the finish line or max_ticks more ticks have passed.
+  // threads == 0 uses one per core.
+  RaceResult run (int finish_line, int max_ticks, unsigned threads = 0);
+
+  std::size_t
+  size () const
+  {
+    return y.size ();
+  }
+  int
+  ticks () const
+  {
+    return tick;
+  }
+  const std::vector<int> &
+  total_steps () const
+  {
+    return y;
+  }
+};
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <random>
 #include <string>
 #include <thread>
 
@@ -58,6 +59,22 @@ Race::race (std::vector<Race::StepperBlob> &blobs)
   draw_blobs (blobs);
 }
 
+// Listing 6.18 Create blobs for a proper race
+std::vector<std::unique_ptr<Race::Blob> >
+Race::create_blobs (int number)
+{
+  std::vector<std::unique_ptr<Blob> > blobs;
+  std::random_device                  rd;
+  for (int i = 0; i < number / 2; ++i)
+    {
+      blobs.emplace_back (std::make_unique<StepperBlob> ());
+      blobs.emplace_back (
+          std::make_unique<RandomBlob<std::default_random_engine, std::uniform_int_distribution<int> > > (
+              std::default_random_engine{ rd () }, std::uniform_int_distribution{ 0, 4 }));
+    }
+  return blobs;
+}
+
 // Listing 6.15 A less predictable race
 void
 Race::race (std::vector<std::unique_ptr<Blob> > &blobs)
@@ -109,3 +126,22 @@ Race::draw_blobs (const std::vector<std::unique_ptr<Race::Blob> > &blobs)
     }
   std::cout << std::string (blobs.size () * 2 + 3, '-') << '\n';
 }
+
+void
+Race::draw_blobs (const std::vector<int> &positions)
+{
+  const int bag_height  = 3;
+  const int race_height = 8;
+  for (int y = race_height; y >= 0; --y)
+    {
+      std::string output = y >= bag_height ? "  " : "| ";
+      for (const int position : positions)
+        {
+          output += position >= y ? "* " : "  ";
+        }
+      output += y >= bag_height ? ' ' : '|';
+      std::cout << output << '\n';
+    }
+  const int edges = 3;
+  std::cout << std::string (positions.size () * 2 + edges, '-') << '\n';
+}
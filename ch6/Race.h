@@ -68,7 +68,13 @@ void move_blobs (std::vector<Race::StepperBlob> &blobs);
 void draw_blobs (const std::vector<Race::StepperBlob> &blobs);
 void race (std::vector<Race::StepperBlob> &blobs);
 
+// Listing 6.18 Create blobs for a proper race: half steppers, half uniform random blobs
+std::vector<std::unique_ptr<Blob> > create_blobs (int number);
+
 void race (std::vector<std::unique_ptr<Blob> > &blob);
 void move_blobs (std::vector<std::unique_ptr<Blob> > &blobs);
 void draw_blobs (const std::vector<std::unique_ptr<Blob> > &blob);
-}
\ No newline at end of file
+
+// The same picture from positions alone, such as a replayed race
+void draw_blobs (const std::vector<int> &positions);
+}
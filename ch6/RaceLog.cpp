@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+
+#include "RaceLog.h"
+
+// The log is:
+//   "BLOBRACE", varint keyframe interval, varint number of blobs
+//   a frame per tick: zigzag varint positions on keyframe ticks, zigzag varint steps since the tick before otherwise
+//   the index: varint count, then per keyframe varint ticks and bytes since the keyframe before
+//   16 bytes, little endian: where the index starts and how many ticks there are
+namespace
+{
+constexpr std::string_view magic         = "BLOBRACE";
+constexpr std::size_t      trailer_bytes = 16;
+constexpr std::size_t      flush_bytes   = 1 << 16;
+
+void
+put_varint (std::string &out, std::uint64_t value)
+{
+  while (value >= 0x80)
+    {
+      out += static_cast<char> (value | 0x80);
+      value >>= 7;
+    }
+  out += static_cast<char> (value);
+}
+
+// Small steps either way become small numbers: 0, -1, 1, -2, ... go to 0, 1, 2, 3, ...
+std::uint64_t
+zigzag (std::int64_t value)
+{
+  return (static_cast<std::uint64_t> (value) << 1) ^ static_cast<std::uint64_t> (value >> 63);
+}
+
+std::int64_t
+unzigzag (std::uint64_t value)
+{
+  return static_cast<std::int64_t> (value >> 1) ^ -static_cast<std::int64_t> (value & 1);
+}
+
+void
+put_fixed (std::string &out, std::uint64_t value)
+{
+  for (int byte = 0; byte < 8; ++byte)
+    {
+      out += static_cast<char> (value >> (8 * byte));
+    }
+}
+
+std::uint64_t
+get_varint (std::streambuf &in)
+{
+  std::uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7)
+    {
+      const auto c = in.sbumpc ();
+      if (c == std::streambuf::traits_type::eof ())
+        {
+          throw std::runtime_error ("Race log is truncated");
+        }
+      value |= static_cast<std::uint64_t> (c & 0x7F) << shift;
+      if ((c & 0x80) == 0)
+        {
+          return value;
+        }
+    }
+  throw std::runtime_error ("Race log has a varint longer than 64 bits");
+}
+
+std::uint64_t
+get_fixed (std::streambuf &in)
+{
+  std::array<char, 8> bytes;
+  if (in.sgetn (bytes.data (), bytes.size ()) != static_cast<std::streamsize> (bytes.size ()))
+    {
+      throw std::runtime_error ("Race log is truncated");
+    }
+  std::uint64_t value = 0;
+  for (int byte = 7; byte >= 0; --byte)
+    {
+      value = (value << 8) | static_cast<unsigned char> (bytes[byte]);
+    }
+  return value;
+}
+}
+
+Race::RaceRecorder::RaceRecorder (std::ostream &out, std::size_t keyframe_interval)
+    : out (out), interval (keyframe_interval)
+{
+  if (interval == 0)
+    {
+      throw std::invalid_argument ("Keyframe interval must be at least one tick");
+    }
+}
+
+Race::RaceRecorder::~RaceRecorder ()
+{
+  if (!finished)
+    {
+      // A destructor must not throw; call finish to hear about a failure
+      try
+        {
+          finish ();
+        }
+      catch (...)
+        {
+        }
+    }
+}
+
+void
+Race::RaceRecorder::start (std::size_t blobs)
+{
+  buffer += magic;
+  put_varint (buffer, interval);
+  put_varint (buffer, blobs);
+  previous.assign (blobs, 0);
+  started = true;
+}
+
+void
+Race::RaceRecorder::flush ()
+{
+  out.write (buffer.data (), static_cast<std::streamsize> (buffer.size ()));
+  written += buffer.size ();
+  buffer.clear ();
+}
+
+void
+Race::RaceRecorder::record (const std::vector<int> &positions)
+{
+  if (finished)
+    {
+      throw std::logic_error ("Race log is already finished");
+    }
+  if (!started)
+    {
+      start (positions.size ());
+    }
+  if (positions.size () != previous.size ())
+    {
+      throw std::invalid_argument ("Every tick of a race log needs the same number of blobs");
+    }
+
+  if (ticks % interval == 0)
+    {
+      keyframes.emplace_back (ticks, written + buffer.size ());
+      for (const int position : positions)
+        {
+          put_varint (buffer, zigzag (position));
+        }
+    }
+  else
+    {
+      for (std::size_t i = 0; i < positions.size (); ++i)
+        {
+          put_varint (buffer, zigzag (std::int64_t{ positions[i] } - previous[i]));
+        }
+    }
+  previous = positions;
+  ++ticks;
+  if (buffer.size () >= flush_bytes)
+    {
+      flush ();
+    }
+}
+
+void
+Race::RaceRecorder::record (const std::vector<std::unique_ptr<Blob> > &blobs)
+{
+  std::vector<int> positions;
+  positions.reserve (blobs.size ());
+  for (const auto &blob : blobs)
+    {
+      positions.push_back (blob->total_steps ());
+    }
+  record (positions);
+}
+
+void
+Race::RaceRecorder::finish ()
+{
+  if (finished)
+    {
+      return;
+    }
+  if (!started)
+    {
+      start (0);
+    }
+  const std::uint64_t index = written + buffer.size ();
+  put_varint (buffer, keyframes.size ());
+  std::pair<std::uint64_t, std::uint64_t> last{};
+  for (const auto &keyframe : keyframes)
+    {
+      put_varint (buffer, keyframe.first - last.first);
+      put_varint (buffer, keyframe.second - last.second);
+      last = keyframe;
+    }
+  put_fixed (buffer, index);
+  put_fixed (buffer, ticks);
+  flush ();
+  out.flush ();
+  finished = true;
+}
+
+Race::RaceReplay::RaceReplay (std::istream &in) : in (in), base (in.tellg ())
+{
+  auto &buffer = *in.rdbuf ();
+  std::array<char, magic.size ()> header;
+  if (buffer.sgetn (header.data (), header.size ()) != static_cast<std::streamsize> (header.size ())
+      || std::string_view (header.data (), header.size ()) != magic)
+    {
+      throw std::runtime_error ("Not a race log");
+    }
+  interval = get_varint (buffer);
+  current.resize (get_varint (buffer));
+  if (interval == 0)
+    {
+      throw std::runtime_error ("Race log has no keyframe interval");
+    }
+
+  in.seekg (-static_cast<std::streamoff> (trailer_bytes), std::ios::end);
+  const std::uint64_t index = get_fixed (buffer);
+  tick_count                = get_fixed (buffer);
+  in.seekg (base + static_cast<std::streamoff> (index));
+  keyframes.resize (get_varint (buffer));
+  std::pair<std::uint64_t, std::uint64_t> last{};
+  for (auto &keyframe : keyframes)
+    {
+      keyframe.first  = last.first + get_varint (buffer);
+      keyframe.second = last.second + get_varint (buffer);
+      last            = keyframe;
+    }
+  if (!in || keyframes.size () != (tick_count + interval - 1) / interval
+      || (!keyframes.empty () && keyframes.front ().first != 0))
+    {
+      throw std::runtime_error ("Race log index does not match its ticks");
+    }
+}
+
+void
+Race::RaceReplay::read_frame (bool keyframe)
+{
+  auto &buffer = *in.rdbuf ();
+  for (auto &position : current)
+    {
+      const std::int64_t value = unzigzag (get_varint (buffer));
+      position                 = static_cast<int> (keyframe ? value : position + value);
+    }
+}
+
+const std::vector<int> &
+Race::RaceReplay::seek (std::uint64_t tick)
+{
+  if (tick >= tick_count)
+    {
+      throw std::out_of_range ("Race log has no such tick");
+    }
+  if (!loaded || tick < at || tick - at >= interval)
+    {
+      const auto keyframe = std::prev (std::upper_bound (
+          keyframes.begin (), keyframes.end (), tick,
+          [] (std::uint64_t wanted, const auto &entry) { return wanted < entry.first; }));
+      in.clear ();
+      in.seekg (base + static_cast<std::streamoff> (keyframe->second));
+      read_frame (true);
+      at     = keyframe->first;
+      loaded = true;
+    }
+  while (at < tick)
+    {
+      ++at;
+      read_frame (at % interval == 0);
+    }
+  return current;
+}
+
+const std::vector<int> &
+Race::RaceReplay::next ()
+{
+  return seek (loaded ? at + 1 : 0);
+}
+
+void
+Race::move_blobs (std::vector<std::unique_ptr<Blob> > &blobs, RaceRecorder &recorder)
+{
+  move_blobs (blobs);
+  recorder.record (blobs);
+}
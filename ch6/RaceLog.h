@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Race.h"
+
+namespace Race
+{
+// Writes a race to a stream tick by tick. Every keyframe_interval ticks the positions go in full; the ticks in
+// between hold only how far each blob moved, as zigzag varints, so a small step costs one byte.
+// finish appends an index of the keyframes, which lets a RaceReplay start near any tick.
+class RaceRecorder
+{
+  std::ostream                                          &out;
+  std::size_t                                            interval;
+  std::vector<int>                                       previous;
+  std::vector<std::pair<std::uint64_t, std::uint64_t> > keyframes; // (tick, offset)
+  std::uint64_t                                          ticks   = 0;
+  std::uint64_t                                          written = 0;
+  std::string                                            buffer;
+  bool                                                   started  = false;
+  bool                                                   finished = false;
+
+  void start (std::size_t blobs);
+  void flush ();
+
+public:
+  explicit RaceRecorder (std::ostream &out, std::size_t keyframe_interval = 64);
+  ~RaceRecorder ();
+
+  RaceRecorder (const RaceRecorder &)            = delete;
+  RaceRecorder &operator= (const RaceRecorder &) = delete;
+
+  // Every tick must have as many blobs as the first
+  void record (const std::vector<int> &positions);
+  void record (const std::vector<std::unique_ptr<Blob> > &blobs);
+  // Writes the index; the destructor does this if nobody has, but cannot report a failure.
+  // Throws whatever the stream does, if its exceptions are set.
+  void finish ();
+
+  std::uint64_t
+  ticks_recorded () const
+  {
+    return ticks;
+  }
+  std::uint64_t
+  bytes_written () const
+  {
+    return written;
+  }
+};
+
+// Reads a finished log back, holding only the index and one tick's positions.
+// The stream must be seekable, as a file or string stream is.
+class RaceReplay
+{
+  std::istream                                          &in;
+  std::istream::pos_type                                 base;
+  std::size_t                                            interval   = 0;
+  std::uint64_t                                          tick_count = 0;
+  std::vector<std::pair<std::uint64_t, std::uint64_t> > keyframes;
+  std::vector<int>                                       current;
+  std::uint64_t                                          at = 0; // the tick in current, if loaded
+  bool                                                   loaded = false;
+
+  void read_frame (bool keyframe);
+
+public:
+  explicit RaceReplay (std::istream &in);
+
+  std::uint64_t
+  ticks () const
+  {
+    return tick_count;
+  }
+  std::size_t
+  blobs () const
+  {
+    return current.size ();
+  }
+  std::uint64_t
+  tick () const
+  {
+    return at;
+  }
+  const std::vector<int> &
+  positions () const
+  {
+    return current;
+  }
+
+  // A binary search of the index for the last keyframe at or before tick, then the deltas from there.
+  // Seeking a little way forward reads on from the current tick instead.
+  const std::vector<int> &seek (std::uint64_t tick);
+  // The tick after the current one, or the first
+  const std::vector<int> &next ();
+};
+
+// Moves the blobs as move_blobs does, then records where they got to
+void move_blobs (std::vector<std::unique_ptr<Blob> > &blobs, RaceRecorder &recorder);
+}
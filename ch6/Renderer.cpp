@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cerrno>
+
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "Renderer.h"
+
+namespace
+{
+// Reprinting a few unchanged cells is cheaper than the escape sequence to skip them
+constexpr std::size_t longest_gap = 4;
+
+void
+move_cursor (std::string &out, std::size_t row, std::size_t column)
+{
+  out += "\x1B[";
+  out += std::to_string (row + 1);
+  out += ';';
+  out += std::to_string (column + 1);
+  out += 'H';
+}
+}
+
+Race::TerminalRenderer::TerminalRenderer (int fd, int width) : fd (fd), width (width)
+{
+  if (this->width <= 0)
+    {
+      winsize size{};
+      this->width = ::ioctl (fd, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 ? size.ws_col : 80;
+    }
+}
+
+std::size_t
+Race::TerminalRenderer::blobs_per_column (std::size_t blobs) const
+{
+  const std::size_t visible = std::max (1, (width - 3) / 2);
+  return std::max<std::size_t> (1, (blobs + visible - 1) / visible);
+}
+
+// The same picture as draw_blobs, one char per cell
+void
+Race::TerminalRenderer::compose (const std::vector<int> &positions)
+{
+  const std::size_t group = blobs_per_column (positions.size ());
+  std::vector<int>  heights;
+  for (std::size_t first = 0; first < positions.size (); first += group)
+    {
+      const auto last = positions.begin () + std::min (positions.size (), first + group);
+      heights.push_back (*std::max_element (positions.begin () + first, last));
+    }
+
+  const std::size_t frame_width = heights.size () * 2 + 3;
+  if (frame_width != columns)
+    {
+      columns = frame_width;
+      front.clear ();
+    }
+  back.assign (rows * columns, ' ');
+  for (int y = race_height; y >= 0; --y)
+    {
+      char *row = &back[(race_height - y) * columns];
+      if (y < bag_height)
+        {
+          row[0]           = '|';
+          row[columns - 1] = '|';
+        }
+      for (std::size_t column = 0; column < heights.size (); ++column)
+        {
+          if (heights[column] >= y)
+            {
+              row[2 + column * 2] = '*';
+            }
+        }
+    }
+  std::fill_n (&back[(rows - 1) * columns], columns, '-');
+}
+
+std::string_view
+Race::TerminalRenderer::frame (const std::vector<int> &positions)
+{
+  compose (positions);
+  out.clear ();
+  if (front.empty ())
+    {
+      // A cleared screen is all spaces, so only the rest needs sending
+      out = "\x1B[2J";
+      front.assign (back.size (), ' ');
+    }
+
+  std::size_t cursor_row = rows, cursor_column = 0; // nowhere in the frame
+  for (std::size_t row = 0; row < rows; ++row)
+    {
+      const char *now    = &back[row * columns];
+      const char *before = &front[row * columns];
+      for (std::size_t start = 0; start < columns; ++start)
+        {
+          if (now[start] == before[start])
+            {
+              continue;
+            }
+          std::size_t last = start;
+          for (std::size_t next = start + 1; next < columns && next - last <= longest_gap; ++next)
+            {
+              if (now[next] != before[next])
+                {
+                  last = next;
+                }
+            }
+          if (cursor_row != row || cursor_column != start)
+            {
+              move_cursor (out, row, start);
+            }
+          out.append (now + start, now + last + 1);
+          cursor_row    = row;
+          cursor_column = last + 1;
+          start         = last;
+        }
+    }
+  if (!out.empty ())
+    {
+      // Leave the cursor under the race
+      move_cursor (out, rows, 0);
+    }
+  std::swap (front, back);
+  return out;
+}
+
+void
+Race::TerminalRenderer::draw (const std::vector<int> &positions)
+{
+  std::string_view bytes = frame (positions);
+  while (!bytes.empty ())
+    {
+      const ssize_t done = ::write (fd, bytes.data (), bytes.size ());
+      if (done < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          reset (); // the screen is unknown now
+          break;
+        }
+      bytes.remove_prefix (static_cast<std::size_t> (done));
+      written += static_cast<std::size_t> (done);
+    }
+}
+
+void
+Race::TerminalRenderer::reset ()
+{
+  front.clear ();
+}
+
+void
+Race::draw_blobs (const std::vector<std::unique_ptr<Race::Blob> > &blobs, TerminalRenderer &renderer)
+{
+  std::vector<int> positions;
+  positions.reserve (blobs.size ());
+  for (const auto &blob : blobs)
+    {
+      positions.push_back (blob->total_steps ());
+    }
+  renderer.draw (positions);
+}
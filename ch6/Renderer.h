@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Race.h"
+
+namespace Race
+{
+// Draws the race as draw_blobs does, but keeps the last frame shown (front) and the one being drawn (back),
+// and sends only the cells that changed, with cursor moves between runs, in one write per frame.
+// A race wider than the terminal is decimated: each column shows the furthest of a group of neighbouring blobs.
+class TerminalRenderer
+{
+  int               fd;
+  int               width; // in characters
+  std::vector<char> front;
+  std::vector<char> back;
+  std::size_t       columns = 0; // frame width in cells, 0 before the first frame
+  std::string       out;
+  std::size_t       written = 0;
+
+  void compose (const std::vector<int> &positions);
+
+public:
+  static constexpr int race_height = 8;
+  static constexpr int bag_height  = 3;
+  static constexpr int rows        = race_height + 2; // the race and the floor
+
+  // width == 0 asks the terminal, falling back to 80 columns
+  explicit TerminalRenderer (int fd = 1, int width = 0);
+
+  // The bytes that would bring the screen from the last frame to this one, without writing them
+  std::string_view frame (const std::vector<int> &positions);
+  void             draw (const std::vector<int> &positions);
+  // Forgets the screen, so the next frame is drawn in full
+  void reset ();
+
+  std::size_t
+  bytes_written () const
+  {
+    return written;
+  }
+  std::size_t
+  blobs_per_column (std::size_t blobs) const;
+};
+
+void draw_blobs (const std::vector<std::unique_ptr<Blob> > &blobs, TerminalRenderer &renderer);
+}
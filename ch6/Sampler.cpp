@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "Sampler.h"
+
+Race::AliasTable::AliasTable (std::span<const double> weights, int offset)
+    : threshold (weights.size ()), alias (weights.size ()), offset (offset)
+{
+  const double total = std::accumulate (weights.begin (), weights.end (), 0.0);
+  if (weights.empty () || !(total > 0.0)
+      || std::any_of (weights.begin (), weights.end (), [] (double w) { return w < 0.0; }))
+    {
+      throw std::invalid_argument ("Alias table needs non-negative weights with a positive total");
+    }
+
+  // Columns below the average lend their spare room to one above it, until every column is full
+  const auto                 n = weights.size ();
+  std::vector<double>        scaled (n);
+  std::vector<std::uint32_t> small, large;
+  for (std::uint32_t i = 0; i < n; ++i)
+    {
+      scaled[i] = weights[i] * static_cast<double> (n) / total;
+      (scaled[i] < 1.0 ? small : large).push_back (i);
+    }
+  while (!small.empty () && !large.empty ())
+    {
+      const std::uint32_t lender = small.back ();
+      const std::uint32_t donor  = large.back ();
+      small.pop_back ();
+      threshold[lender] = static_cast<std::uint32_t> (std::min (scaled[lender] * 4294967296.0, 4294967295.0));
+      alias[lender]     = donor;
+      scaled[donor] -= 1.0 - scaled[lender];
+      if (scaled[donor] < 1.0)
+        {
+          large.pop_back ();
+          small.push_back (donor);
+        }
+    }
+  // Whatever is left is full, give or take rounding
+  for (const auto i : small)
+    {
+      alias[i] = i;
+    }
+  for (const auto i : large)
+    {
+      alias[i] = i;
+    }
+}
+
+Race::AliasTable
+Race::AliasTable::uniform_int (int min, int max)
+{
+  if (max < min)
+    {
+      throw std::invalid_argument ("Uniform distribution needs min <= max");
+    }
+  const std::vector<double> weights (static_cast<std::size_t> (static_cast<std::int64_t> (max) - min + 1), 1.0);
+  return AliasTable (weights, min);
+}
+
+Race::AliasTable
+Race::AliasTable::poisson (double mean)
+{
+  if (!(mean > 0.0) || mean > 700.0)
+    {
+      throw std::invalid_argument ("Poisson mean must be in (0, 700]");
+    }
+  std::vector<double> weights;
+  double              probability = std::exp (-mean);
+  double              cumulative  = 0.0;
+  for (int k = 0; cumulative < 1.0 - 1e-12 && (k <= mean || probability > 1e-300); ++k)
+    {
+      weights.push_back (probability);
+      cumulative += probability;
+      probability *= mean / (k + 1);
+    }
+  return AliasTable (weights, 0);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Race
+{
+// Walker's alias method (in Vose's form) for a distribution over offset, offset + 1, ...:
+// any outcome costs one uniform draw, one table look up and one comparison, whatever the distribution.
+class AliasTable
+{
+  std::vector<std::uint32_t> threshold; // keep the column below this, scaled to 2^32, else take its alias
+  std::vector<std::uint32_t> alias;     // a full column is its own alias
+  int                        offset;
+
+public:
+  AliasTable (std::span<const double> weights, int offset = 0);
+
+  static AliasTable uniform_int (int min, int max);
+  // Cut off where the rest of the tail is below one in a trillion
+  static AliasTable poisson (double mean);
+
+  std::size_t
+  size () const
+  {
+    return alias.size ();
+  }
+
+  // The high half of the bits picks the column, the low half decides between it and its alias
+  int
+  sample (std::uint64_t bits) const
+  {
+    const auto column = static_cast<std::size_t> (((bits >> 32) * alias.size ()) >> 32);
+    const auto within = static_cast<std::uint32_t> (bits);
+    return offset + static_cast<int> (within < threshold[column] ? column : alias[column]);
+  }
+
+  template <std::uniform_random_bit_generator G>
+  int
+  operator() (G &generator) const
+  {
+    return sample (bits64 (generator));
+  }
+
+  // As many calls of the generator as it takes to fill 64 bits
+  template <std::uniform_random_bit_generator G>
+  static std::uint64_t
+  bits64 (G &generator)
+  {
+    constexpr int step = std::bit_width (G::max () - G::min ()) - 1; // bits every call is sure to give
+    std::uint64_t bits = 0;
+    for (int filled = 0; filled < 64; filled += step)
+      {
+        bits = (bits << step) ^ static_cast<std::uint64_t> (generator () - G::min ());
+      }
+    return bits;
+  }
+};
+
+// A distribution for RandomBlob that draws its steps Size at a time from a shared alias table,
+// then hands them out one per call until it needs to refill, so RandomBlob's step is usually a load.
+// Each copy has its own buffer: give every blob one for a buffer per blob, or share one through std::ref
+// for a buffer per group.
+template <std::size_t Size = 64> class BatchedSampler
+{
+  std::shared_ptr<const AliasTable> table;
+  std::array<int, Size>             buffer{};
+  std::size_t                       next = Size;
+
+public:
+  explicit BatchedSampler (AliasTable table) : table (std::make_shared<const AliasTable> (std::move (table))) {}
+  explicit BatchedSampler (std::shared_ptr<const AliasTable> table) : table (std::move (table)) {}
+
+  template <std::uniform_random_bit_generator G>
+  int
+  operator() (G &generator)
+  {
+    if (next == Size)
+      {
+        refill (generator);
+      }
+    return buffer[next++];
+  }
+
+  // The blob's generator only seeds each batch; splitmix64 stretches the seed to the whole buffer
+  template <std::uniform_random_bit_generator G>
+  void
+  refill (G &generator)
+  {
+    std::uint64_t     state = AliasTable::bits64 (generator);
+    const AliasTable &alias = *table;
+    for (auto &value : buffer)
+      {
+        std::uint64_t bits = (state += 0x9E3779B97F4A7C15ull);
+        bits               = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ull;
+        bits               = (bits ^ (bits >> 27)) * 0x94D049BB133111EBull;
+        bits ^= bits >> 31;
+        value = alias.sample (bits);
+      }
+    next = 0;
+  }
+};
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include "Tournament.h"
+
+namespace
+{
+std::uint64_t
+splitmix64 (std::uint64_t x)
+{
+  std::uint64_t z = x + 0x9E3779B97F4A7C15ull;
+  z               = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z               = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+std::uint64_t
+blob_seed (std::uint64_t seed, std::uint64_t race, std::size_t entrant)
+{
+  return splitmix64 (splitmix64 (seed ^ splitmix64 (race)) + entrant);
+}
+
+constexpr std::uint64_t races_per_chunk = 1024;
+
+// One thread's tallies, on cache lines of their own
+struct alignas (64) Tally
+{
+  std::vector<Race::EntrantResult> entrants;
+};
+
+void
+record_distance (Race::EntrantResult &entrant, int distance)
+{
+  const auto bucket = static_cast<std::size_t> (std::max (distance, 0));
+  if (bucket >= entrant.distances.size ())
+    {
+      entrant.distances.resize (bucket + 1);
+    }
+  ++entrant.distances[bucket];
+}
+
+template <typename Distribution>
+Race::Entrant
+random_entrant (std::string name, Distribution distribution)
+{
+  return { std::move (name), [distribution] (std::uint64_t seed) -> std::unique_ptr<Race::Blob> {
+            using Engine = std::default_random_engine;
+            return std::make_unique<Race::RandomBlob<Engine, Distribution> > (
+                Engine{ static_cast<Engine::result_type> (seed) }, distribution);
+          } };
+}
+}
+
+Race::Entrant
+Race::stepper_entrant ()
+{
+  return { "Stepper", [] (std::uint64_t) -> std::unique_ptr<Blob> { return std::make_unique<StepperBlob> (); } };
+}
+
+Race::Entrant
+Race::uniform_entrant (int min, int max)
+{
+  return random_entrant ("Uniform " + std::to_string (min) + '-' + std::to_string (max),
+                         std::uniform_int_distribution{ min, max });
+}
+
+Race::Entrant
+Race::poisson_entrant (double mean)
+{
+  std::ostringstream name;
+  name << "Poisson " << mean;
+  return random_entrant (name.str (), std::poisson_distribution{ mean });
+}
+
+std::pair<double, double>
+Race::EntrantResult::win_interval (std::uint64_t races, double z) const
+{
+  if (races == 0)
+    {
+      return { 0.0, 1.0 };
+    }
+  const double n      = static_cast<double> (races);
+  const double p      = wins / n;
+  const double z2     = z * z;
+  const double centre = (p + z2 / (2 * n)) / (1 + z2 / n);
+  const double spread = z / (1 + z2 / n) * std::sqrt (p * (1 - p) / n + z2 / (4 * n * n));
+  return { std::max (0.0, centre - spread), std::min (1.0, centre + spread) };
+}
+
+double
+Race::EntrantResult::mean_distance () const
+{
+  double        total = 0.0;
+  std::uint64_t count = 0;
+  for (std::size_t distance = 0; distance < distances.size (); ++distance)
+    {
+      total += static_cast<double> (distance) * distances[distance];
+      count += distances[distance];
+    }
+  return count ? total / count : 0.0;
+}
+
+Race::TournamentResult
+Race::run_tournament (const std::vector<Entrant> &entrants, const TournamentOptions &options)
+{
+  const unsigned threads
+      = options.threads ? options.threads : std::max (1u, std::thread::hardware_concurrency ());
+  const std::uint64_t chunks = (options.races + races_per_chunk - 1) / races_per_chunk;
+
+  std::vector<Tally> tallies (threads);
+  for (auto &tally : tallies)
+    {
+      for (const auto &entrant : entrants)
+        {
+          tally.entrants.push_back ({ entrant.name, 0, 0, {} });
+        }
+    }
+
+  std::atomic<std::uint64_t> next_chunk{};
+  auto                       work = [&] (Tally &tally) {
+    std::vector<std::unique_ptr<Blob> > blobs (entrants.size ());
+    std::vector<int>                    distances (entrants.size ());
+    for (std::uint64_t chunk = next_chunk++; chunk < chunks; chunk = next_chunk++)
+      {
+        const std::uint64_t last = std::min (options.races, (chunk + 1) * races_per_chunk);
+        for (std::uint64_t race = chunk * races_per_chunk; race < last; ++race)
+          {
+            for (std::size_t i = 0; i < entrants.size (); ++i)
+              {
+                blobs[i] = entrants[i].make (blob_seed (options.seed, race, i));
+              }
+            for (int step = 0; step < options.steps; ++step)
+              {
+                move_blobs (blobs);
+              }
+            for (std::size_t i = 0; i < entrants.size (); ++i)
+              {
+                distances[i] = blobs[i]->total_steps ();
+                record_distance (tally.entrants[i], distances[i]);
+              }
+            const int  furthest = *std::max_element (distances.begin (), distances.end ());
+            const auto leaders  = std::count (distances.begin (), distances.end (), furthest);
+            for (std::size_t i = 0; i < entrants.size (); ++i)
+              {
+                if (distances[i] == furthest)
+                  {
+                    ++(leaders == 1 ? tally.entrants[i].wins : tally.entrants[i].ties);
+                  }
+              }
+          }
+      }
+  };
+  if (!entrants.empty ())
+    {
+      std::vector<std::jthread> pool;
+      for (auto &tally : tallies)
+        {
+          pool.emplace_back (work, std::ref (tally));
+        }
+    }
+
+  TournamentResult result{ options.races, std::move (tallies[0].entrants) };
+  for (std::size_t t = 1; t < tallies.size (); ++t)
+    {
+      for (std::size_t i = 0; i < entrants.size (); ++i)
+        {
+          EntrantResult       &total = result.entrants[i];
+          const EntrantResult &part  = tallies[t].entrants[i];
+          total.wins += part.wins;
+          total.ties += part.ties;
+          if (part.distances.size () > total.distances.size ())
+            {
+              total.distances.resize (part.distances.size ());
+            }
+          std::transform (part.distances.begin (), part.distances.end (), total.distances.begin (),
+                          total.distances.begin (), std::plus<> ());
+        }
+    }
+  return result;
+}
+
+std::ostream &
+Race::operator<< (std::ostream &os, const TournamentResult &result)
+{
+  os << result.races << " races\n";
+  for (std::size_t i = 0; i < result.entrants.size (); ++i)
+    {
+      const auto &entrant          = result.entrants[i];
+      const auto [lowest, highest] = entrant.win_interval (result.races);
+      os << entrant.name << ": wins " << result.win_probability (i) << " [" << lowest << ", " << highest
+         << "], ties " << static_cast<double> (entrant.ties) / std::max<std::uint64_t> (result.races, 1)
+         << ", mean distance " << entrant.mean_distance () << '\n';
+      for (std::size_t distance = 0; distance < entrant.distances.size (); ++distance)
+        {
+          if (entrant.distances[distance])
+            {
+              os << std::setw (5) << distance << ' ' << entrant.distances[distance] << '\n';
+            }
+        }
+    }
+  return os;
+}
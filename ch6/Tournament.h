@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Race.h"
+
+namespace Race
+{
+// A kind of blob to enter in every race, made afresh for each race from a seed
+struct Entrant
+{
+  std::string                                          name;
+  std::function<std::unique_ptr<Blob> (std::uint64_t)> make;
+};
+
+Entrant stepper_entrant ();
+Entrant uniform_entrant (int min, int max);
+Entrant poisson_entrant (double mean);
+
+struct TournamentOptions
+{
+  std::uint64_t races   = 1'000'000;
+  int           steps   = 3; // moves per race, as in race
+  unsigned      threads = 0; // 0 for one per core
+  std::uint64_t seed    = 0;
+};
+
+struct EntrantResult
+{
+  std::string                name;
+  std::uint64_t              wins{}; // furthest on its own
+  std::uint64_t              ties{}; // furthest along with others
+  std::vector<std::uint64_t> distances; // races finishing at each distance, negative ones counted at 0
+
+  // Wilson score interval for the chance of an outright win, at z standard deviations
+  std::pair<double, double> win_interval (std::uint64_t races, double z = 1.96) const;
+  double                    mean_distance () const;
+};
+
+struct TournamentResult
+{
+  std::uint64_t              races{};
+  std::vector<EntrantResult> entrants;
+
+  double
+  win_probability (std::size_t entrant) const
+  {
+    return races ? static_cast<double> (entrants[entrant].wins) / races : 0.0;
+  }
+};
+
+// Runs every race headless, spread over a pool of threads each with its own tallies, merged at the end.
+// Race r seeds its blobs from the seed and r alone, so the result does not depend on the number of threads.
+TournamentResult run_tournament (const std::vector<Entrant> &entrants, const TournamentOptions &options);
+
+std::ostream &operator<< (std::ostream &os, const TournamentResult &result);
+}
@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+#include "Track.h"
+
+namespace
+{
+// Room for twice as many items as buckets, rounded up to a power of two so a mask picks the bucket
+std::size_t
+bucket_count (std::size_t items)
+{
+  return std::bit_ceil (std::max<std::size_t> (items * 2, 16));
+}
+}
+
+Race::Track::Track (float width, float blob_radius, std::vector<Obstacle> obstacles)
+    : width (width), radius (blob_radius), cell (2 * blob_radius),
+      row_cells (static_cast<std::size_t> (std::ceil (width / cell)) + 2), obstacles (std::move (obstacles))
+{
+  if (!(blob_radius > 0.0f) || !(width > cell))
+    {
+      throw std::invalid_argument ("Track needs blobs with a positive radius, narrower than the track");
+    }
+
+  // Each obstacle goes in every cell where a blob could touch it
+  std::vector<std::pair<std::size_t, std::uint32_t> > cells; // (bucket, obstacle), before buckets are known
+  std::vector<std::pair<std::int32_t, std::int32_t> > spans;
+  for (const auto &obstacle : this->obstacles)
+    {
+      const float reach = obstacle.radius + radius;
+      spans.emplace_back (cell_of (obstacle.x - reach), cell_of (obstacle.x + reach));
+      spans.emplace_back (cell_of (obstacle.y - reach), cell_of (obstacle.y + reach));
+    }
+  std::size_t entries = 0;
+  for (std::size_t i = 0; i < this->obstacles.size (); ++i)
+    {
+      entries += static_cast<std::size_t> (spans[2 * i].second - spans[2 * i].first + 1)
+                 * static_cast<std::size_t> (spans[2 * i + 1].second - spans[2 * i + 1].first + 1);
+    }
+  const std::size_t buckets = bucket_count (entries);
+  obstacle_grid.starts.assign (buckets + 1, 0);
+  for (std::uint32_t i = 0; i < this->obstacles.size (); ++i)
+    {
+      for (auto y = spans[2 * i + 1].first; y <= spans[2 * i + 1].second; ++y)
+        {
+          for (auto x = spans[2 * i].first; x <= spans[2 * i].second; ++x)
+            {
+              cells.emplace_back (bucket (x, y, buckets), i);
+            }
+        }
+    }
+  // Cells of one obstacle can hash to the same bucket; it goes in each bucket once, or a blob hits it twice
+  std::ranges::sort (cells);
+  const auto repeats = std::ranges::unique (cells);
+  cells.erase (repeats.begin (), repeats.end ());
+  for (const auto &[b, obstacle] : cells)
+    {
+      ++obstacle_grid.starts[b + 1];
+    }
+  for (std::size_t b = 0; b < buckets; ++b)
+    {
+      obstacle_grid.starts[b + 1] += obstacle_grid.starts[b];
+    }
+  obstacle_grid.entries.resize (cells.size ());
+  fill.assign (obstacle_grid.starts.begin (), obstacle_grid.starts.end () - 1);
+  for (const auto &[b, obstacle] : cells)
+    {
+      obstacle_grid.entries[fill[b]++] = obstacle;
+    }
+}
+
+std::size_t
+Race::Track::bucket (std::int32_t x, std::int32_t y, std::size_t buckets) const
+{
+  // Row by row, so neighbouring cells land in neighbouring buckets
+  return (static_cast<std::size_t> (static_cast<std::uint32_t> (y)) * row_cells
+          + static_cast<std::size_t> (static_cast<std::uint32_t> (x)))
+         & (buckets - 1);
+}
+
+std::int32_t
+Race::Track::cell_of (float position) const
+{
+  return static_cast<std::int32_t> (std::floor (position / cell));
+}
+
+Race::MovingBlob &
+Race::Track::add_blob (float x, float y, float vx, float vy)
+{
+  MovingBlob &blob = arena.create<MovingBlob> (x, y, vx, vy);
+  movers.push_back (&blob);
+  return blob;
+}
+
+void
+Race::Track::tick ()
+{
+  for (auto *blob : movers)
+    {
+      blob->step (); // final, so a direct call
+    }
+  build_blob_grid ();
+  collide_blobs ();
+  collide_with_obstacles ();
+  collide_with_walls ();
+}
+
+// A counting sort of the blobs by bucket: O(n), with no allocation once the vectors have grown
+void
+Race::Track::build_blob_grid ()
+{
+  const std::size_t n       = movers.size ();
+  const std::size_t buckets = bucket_count (n);
+  cell_x.resize (n);
+  cell_y.resize (n);
+  blob_grid.starts.assign (buckets + 1, 0);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      cell_x[i] = cell_of (movers[i]->x);
+      cell_y[i] = cell_of (movers[i]->y);
+      ++blob_grid.starts[bucket (cell_x[i], cell_y[i], buckets) + 1];
+    }
+  for (std::size_t b = 0; b < buckets; ++b)
+    {
+      blob_grid.starts[b + 1] += blob_grid.starts[b];
+    }
+  blob_grid.entries.resize (n);
+  fill.assign (blob_grid.starts.begin (), blob_grid.starts.end () - 1);
+  for (std::uint32_t i = 0; i < n; ++i)
+    {
+      blob_grid.entries[fill[bucket (cell_x[i], cell_y[i], buckets)]++] = i;
+    }
+  // A copy of what the collision checks read, in the same order, so they read memory in order
+  sorted.resize (n);
+  for (std::size_t k = 0; k < n; ++k)
+    {
+      const std::uint32_t i = blob_grid.entries[k];
+      sorted[k]             = { movers[i]->x, movers[i]->y, cell_x[i], cell_y[i] };
+    }
+}
+
+// Blobs one cell across can only touch blobs in the same or a neighbouring cell.
+// Checking the cell as well as the bucket skips other cells which happen to share the bucket,
+// and only looking later in the grid order finds each pair once.
+void
+Race::Track::collide_blobs ()
+{
+  touching.clear ();
+  const std::size_t buckets           = blob_grid.starts.size () - 1;
+  const float       touching_distance = 2 * radius;
+  for (std::uint32_t k = 0; k < sorted.size (); ++k)
+    {
+      const Placed &a = sorted[k];
+      for (std::int32_t dy = -1; dy <= 1; ++dy)
+        {
+          for (std::int32_t dx = -1; dx <= 1; ++dx)
+            {
+              const std::int32_t x = a.cell_x + dx, y = a.cell_y + dy;
+              const std::size_t  b = bucket (x, y, buckets);
+              for (auto other = std::max (blob_grid.starts[b], k + 1); other < blob_grid.starts[b + 1]; ++other)
+                {
+                  const Placed &c = sorted[other];
+                  if (c.cell_x != x || c.cell_y != y)
+                    {
+                      continue;
+                    }
+                  const float ox = c.x - a.x, oy = c.y - a.y;
+                  if (ox * ox + oy * oy < touching_distance * touching_distance)
+                    {
+                      touching.emplace_back (std::minmax (blob_grid.entries[k], blob_grid.entries[other]));
+                    }
+                }
+            }
+        }
+    }
+
+  // Equal masses: push the pair apart and swap their velocities along the line between them
+  for (const auto &[i, j] : touching)
+    {
+      MovingBlob &a  = *movers[i];
+      MovingBlob &b  = *movers[j];
+      float       nx = b.x - a.x, ny = b.y - a.y;
+      const float distance = std::sqrt (nx * nx + ny * ny);
+      if (distance > 0.0f)
+        {
+          nx /= distance;
+          ny /= distance;
+        }
+      else
+        {
+          nx = 1.0f;
+          ny = 0.0f;
+        }
+      const float overlap = touching_distance - distance;
+      if (overlap > 0.0f)
+        {
+          a.x -= nx * overlap / 2;
+          a.y -= ny * overlap / 2;
+          b.x += nx * overlap / 2;
+          b.y += ny * overlap / 2;
+        }
+      const float closing = (a.vx - b.vx) * nx + (a.vy - b.vy) * ny;
+      if (closing > 0.0f)
+        {
+          a.vx -= closing * nx;
+          a.vy -= closing * ny;
+          b.vx += closing * nx;
+          b.vy += closing * ny;
+        }
+    }
+}
+
+// Obstacles do not move: a blob is pushed out and bounces off
+void
+Race::Track::collide_with_obstacles ()
+{
+  bumps = 0;
+  if (obstacles.empty ())
+    {
+      return;
+    }
+  const std::size_t buckets = obstacle_grid.starts.size () - 1;
+  for (auto *blob : movers)
+    {
+      const std::size_t b = bucket (cell_of (blob->x), cell_of (blob->y), buckets);
+      for (auto k = obstacle_grid.starts[b]; k < obstacle_grid.starts[b + 1]; ++k)
+        {
+          const Obstacle &obstacle = obstacles[obstacle_grid.entries[k]];
+          float           nx = blob->x - obstacle.x, ny = blob->y - obstacle.y;
+          const float     distance = std::sqrt (nx * nx + ny * ny);
+          const float     closest  = obstacle.radius + radius;
+          if (distance >= closest)
+            {
+              continue;
+            }
+          if (distance > 0.0f)
+            {
+              nx /= distance;
+              ny /= distance;
+            }
+          else
+            {
+              nx = 0.0f;
+              ny = -1.0f;
+            }
+          blob->x = obstacle.x + nx * closest;
+          blob->y = obstacle.y + ny * closest;
+          const float into = blob->vx * nx + blob->vy * ny;
+          if (into < 0.0f)
+            {
+              blob->vx -= 2 * into * nx;
+              blob->vy -= 2 * into * ny;
+            }
+          ++bumps;
+        }
+    }
+}
+
+void
+Race::Track::collide_with_walls ()
+{
+  for (auto *blob : movers)
+    {
+      if (blob->x < radius)
+        {
+          blob->x  = radius;
+          blob->vx = std::abs (blob->vx);
+        }
+      else if (blob->x > width - radius)
+        {
+          blob->x  = width - radius;
+          blob->vx = -std::abs (blob->vx);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "BlobArena.h"
+#include "Race.h"
+
+namespace Race
+{
+// A blob on a 2D track: it moves by its velocity each step, and its distance is how far up the track it is
+class MovingBlob final : public Blob
+{
+public:
+  float x, y, vx, vy;
+
+  MovingBlob (float x, float y, float vx, float vy) : x (x), y (y), vx (vx), vy (vy) {}
+
+  void
+  step () override
+  {
+    x += vx;
+    y += vy;
+  }
+  int
+  total_steps () const override
+  {
+    return static_cast<int> (y);
+  }
+};
+
+struct Obstacle
+{
+  float x, y, radius;
+};
+
+// Blobs, all the same size, racing up a track between two walls, bumping into each other and into obstacles.
+// Each tick the blobs are counting sorted into a hash of grid cells one blob across, so a blob only
+// needs checking against the blobs in its own and the eight neighbouring cells.
+class Track
+{
+  // Items counting sorted by hashed cell: bucket b holds entries[starts[b]] up to entries[starts[b + 1]]
+  struct Grid
+  {
+    std::vector<std::uint32_t> starts;
+    std::vector<std::uint32_t> entries;
+  };
+
+  struct Placed
+  {
+    float        x, y;
+    std::int32_t cell_x, cell_y;
+  };
+
+  float                                                 width;
+  float                                                 radius;
+  float                                                 cell;
+  std::size_t                                           row_cells; // across the track, with one spare each side
+  BlobArena                                             arena;
+  std::vector<MovingBlob *>                             movers;
+  std::vector<Obstacle>                                 obstacles;
+  Grid                                                  obstacle_grid;
+  Grid                                                  blob_grid;
+  std::vector<std::int32_t>                             cell_x, cell_y; // of each blob this tick
+  std::vector<std::uint32_t>                            fill;           // next free entry of each bucket
+  std::vector<Placed>                                   sorted;         // the blobs, in blob_grid order
+  std::vector<std::pair<std::uint32_t, std::uint32_t> > touching;
+  std::size_t                                           bumps = 0;
+
+  std::size_t  bucket (std::int32_t x, std::int32_t y, std::size_t buckets) const;
+  std::int32_t cell_of (float position) const;
+  void         build_blob_grid ();
+  void         collide_blobs ();
+  void         collide_with_obstacles ();
+  void         collide_with_walls ();
+
+public:
+  Track (float width, float blob_radius = 0.5f, std::vector<Obstacle> obstacles = {});
+
+  MovingBlob &add_blob (float x, float y, float vx, float vy);
+
+  // Moves every blob, then settles any collisions
+  void tick ();
+
+  std::vector<BlobHandle> &
+  blobs ()
+  {
+    return arena.blobs ();
+  }
+  // Pairs of blobs, by index, found touching in the last tick
+  const std::vector<std::pair<std::uint32_t, std::uint32_t> > &
+  contacts () const
+  {
+    return touching;
+  }
+  std::size_t
+  obstacle_hits () const
+  {
+    return bumps;
+  }
+};
+}
@@ -0,0 +1,192 @@
+// Steps per second for a million blobs, through unique_ptr<Blob> and through BlobEngine.
+// A separate program from main.cpp: build it with the other ch6 sources, less main.cpp and the other programs.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "BlobArena.h"
+#include "BlobEngine.h"
+#include "ParallelRace.h"
+#include "RaceLog.h"
+#include "Race.h"
+#include "Sampler.h"
+#include "Track.h"
+
+namespace
+{
+template <typename F>
+double
+steps_per_second (double blobs, int ticks, F tick)
+{
+  const auto start = std::chrono::steady_clock::now ();
+  for (int i = 0; i < ticks; ++i)
+    {
+      tick ();
+    }
+  const auto elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now () - start);
+  return blobs * ticks / elapsed.count ();
+}
+}
+
+int
+main (int argc, char *argv[])
+{
+  const int number = argc > 1 ? std::atoi (argv[1]) : 1'000'000;
+  const int ticks  = argc > 2 ? std::atoi (argv[2]) : 20;
+
+  auto         blobs        = Race::create_blobs (number);
+  const double virtual_rate = steps_per_second (number, ticks, [&] () { Race::move_blobs (blobs); });
+
+  Race::BlobEngine engine (std::random_device{}());
+  engine.add_steppers (number / 2);
+  engine.add_uniform (number / 2, 0, 4);
+  const double engine_rate = steps_per_second (number, ticks, [&] () { engine.step (); });
+
+  Race::BlobEngine poisson_engine;
+  poisson_engine.add_poisson (number, 2.0);
+  const double poisson_rate = steps_per_second (number, ticks, [&] () { poisson_engine.step (); });
+
+  std::cout << number << " blobs, " << ticks << " ticks\n"
+            << "unique_ptr<Blob>: " << virtual_rate << " steps/s\n"
+            << "BlobEngine:       " << engine_rate << " steps/s (" << engine_rate / virtual_rate << "x)\n"
+            << "BlobEngine, Poisson blobs: " << poisson_rate << " steps/s\n";
+
+  // RandomBlob's step with the standard distributions and with batches from alias tables
+  {
+    using Engine   = std::default_random_engine;
+    const int few  = 1000;
+    const int many = number / few;
+    auto      time_blobs = [&] (const char *name, auto make) {
+      std::vector<decltype (make (0))> blobs;
+      for (int i = 0; i < few; ++i)
+        {
+          blobs.emplace_back (make (i));
+        }
+      const double rate = steps_per_second (few, many, [&] () {
+        for (auto &blob : blobs)
+          {
+            blob->step ();
+          }
+      });
+      std::cout << name << ": " << rate << " steps/s\n";
+      return rate;
+    };
+    const auto uniform_table = std::make_shared<const Race::AliasTable> (Race::AliasTable::uniform_int (0, 4));
+    const auto poisson_table = std::make_shared<const Race::AliasTable> (Race::AliasTable::poisson (2.0));
+    const double uniform_std   = time_blobs ("RandomBlob, uniform_int_distribution", [] (int seed) {
+      return std::make_unique<Race::RandomBlob<Engine, std::uniform_int_distribution<int> > > (
+          Engine (seed), std::uniform_int_distribution{ 0, 4 });
+    });
+    const double uniform_batch = time_blobs ("RandomBlob, batched uniform", [&] (int seed) {
+      return std::make_unique<Race::RandomBlob<Engine, Race::BatchedSampler<> > > (
+          Engine (seed), Race::BatchedSampler<> (uniform_table));
+    });
+    const double poisson_std   = time_blobs ("RandomBlob, poisson_distribution", [] (int seed) {
+      return std::make_unique<Race::RandomBlob<Engine, std::poisson_distribution<int> > > (
+          Engine (seed), std::poisson_distribution{ 2.0 });
+    });
+    const double poisson_batch = time_blobs ("RandomBlob, batched Poisson", [&] (int seed) {
+      return std::make_unique<Race::RandomBlob<Engine, Race::BatchedSampler<> > > (
+          Engine (seed), Race::BatchedSampler<> (poisson_table));
+    });
+    std::cout << "Batched speed up: uniform " << uniform_batch / uniform_std << "x, Poisson "
+              << poisson_batch / poisson_std << "x\n";
+  }
+
+  // Creating and tearing down every blob, one allocation each against one arena
+  using UniformBlob = Race::RandomBlob<std::default_random_engine, std::uniform_int_distribution<int> >;
+  const auto heap_start = std::chrono::steady_clock::now ();
+  {
+    std::vector<std::unique_ptr<Race::Blob> > heap_blobs;
+    std::default_random_engine                seeds{ 1 };
+    for (int i = 0; i < number / 2; ++i)
+      {
+        heap_blobs.emplace_back (std::make_unique<Race::StepperBlob> ());
+        heap_blobs.emplace_back (std::make_unique<UniformBlob> (std::default_random_engine{ seeds () },
+                                                                std::uniform_int_distribution{ 0, 4 }));
+      }
+  }
+  const std::chrono::duration<double, std::milli> heap_time = std::chrono::steady_clock::now () - heap_start;
+  const auto                                      arena_start = std::chrono::steady_clock::now ();
+  {
+    Race::BlobArena            arena (number / 2 * (sizeof (Race::StepperBlob) + sizeof (UniformBlob)), number);
+    std::default_random_engine seeds{ 1 };
+    for (int i = 0; i < number / 2; ++i)
+      {
+        arena.create<Race::StepperBlob> ();
+        arena.create<UniformBlob> (std::default_random_engine{ seeds () }, std::uniform_int_distribution{ 0, 4 });
+      }
+  }
+  const std::chrono::duration<double, std::milli> arena_time = std::chrono::steady_clock::now () - arena_start;
+  std::cout << "Create and destroy: make_unique " << heap_time.count () << "ms, BlobArena " << arena_time.count ()
+            << "ms\n";
+
+  // A hundred thousand blobs on a 2D track, about one per twenty cells
+  {
+    const int                             blobs_2d = 100'000;
+    Race::Track                           track (1000.0f, 0.5f, { { 500.0f, 100.0f, 20.0f } });
+    std::mt19937                          gen (1);
+    std::uniform_real_distribution<float> across (0.5f, 999.5f), along (0.0f, 2000.0f), sideways (-0.2f, 0.2f),
+        forward (0.2f, 1.0f);
+    for (int i = 0; i < blobs_2d; ++i)
+      {
+        track.add_blob (across (gen), along (gen), sideways (gen), forward (gen));
+      }
+    std::size_t contacts = 0;
+    const double rate = steps_per_second (1.0, ticks, [&] () {
+      track.tick ();
+      contacts += track.contacts ().size ();
+    });
+    std::cout << "Track, " << blobs_2d << " blobs: " << rate << " ticks/s, " << contacts / ticks
+              << " contacts a tick\n";
+  }
+
+  // Recording a race as it runs, then jumping about in the recording
+  {
+    const int         recorded = 10'000;
+    const int         length   = 1000;
+    auto              racers   = Race::create_blobs (recorded);
+    std::stringstream log;
+    const auto        record_start = std::chrono::steady_clock::now ();
+    {
+      Race::RaceRecorder recorder (log);
+      for (int tick = 0; tick < length; ++tick)
+        {
+          Race::move_blobs (racers, recorder);
+        }
+    }
+    const std::chrono::duration<double, std::milli> record_time = std::chrono::steady_clock::now () - record_start;
+
+    Race::RaceReplay                             replay (log);
+    std::mt19937                                 gen (1);
+    std::uniform_int_distribution<std::uint64_t> any_tick (0, length - 1);
+    const int                                    seeks      = 200;
+    const auto                                   seek_start = std::chrono::steady_clock::now ();
+    for (int i = 0; i < seeks; ++i)
+      {
+        replay.seek (any_tick (gen));
+      }
+    const std::chrono::duration<double, std::milli> seek_time = std::chrono::steady_clock::now () - seek_start;
+    std::cout << "Race log, " << recorded << " blobs for " << length << " ticks: "
+              << static_cast<double> (log.str ().size ()) / (recorded * length) << " bytes a blob a tick, recorded in "
+              << record_time.count () << "ms, " << seek_time.count () / seeks << "ms a seek\n";
+  }
+
+  // No finish line, so every run steps for the same number of ticks
+  for (unsigned threads = 1; threads <= std::thread::hardware_concurrency (); threads *= 2)
+    {
+      Race::ParallelRace race (1);
+      race.add_steppers (number / 2);
+      race.add_uniform (number / 2, 0, 4);
+      const double rate = steps_per_second (1.0 * number * ticks, 1, [&] () {
+        race.run (std::numeric_limits<int>::max (), ticks, threads);
+      });
+      std::cout << "ParallelRace, " << threads << " threads: " << rate << " steps/s\n";
+    }
+}
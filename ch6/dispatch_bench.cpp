@@ -0,0 +1,367 @@
+// The same blobs stepped through different kinds of dispatch, with cycles and branch mispredictions per step
+// from the kernel's hardware counters (perf_event_open), or just time per step where those are not allowed.
+// A separate program from main.cpp: build it with Race.cpp.
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <typeinfo>
+#include <variant>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "Race.h"
+
+namespace
+{
+using Engine      = std::default_random_engine;
+using UniformBlob = Race::RandomBlob<Engine, std::uniform_int_distribution<int> >;
+using PoissonBlob = Race::RandomBlob<Engine, std::poisson_distribution<int> >;
+
+// Cycles, instructions, branches and branch misses, read together as one group
+class PerfCounters
+{
+  static constexpr std::array<std::uint64_t, 4> events{ PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                         PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+                                                         PERF_COUNT_HW_BRANCH_MISSES };
+  std::array<int, 4> fds{ -1, -1, -1, -1 };
+  int                error = 0;
+
+public:
+  PerfCounters ()
+  {
+    for (std::size_t i = 0; i < events.size (); ++i)
+      {
+        perf_event_attr attr{};
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof (attr);
+        attr.config         = events[i];
+        attr.disabled       = i == 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP;
+        fds[i]              = static_cast<int> (::syscall (SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0));
+        if (fds[i] < 0)
+          {
+            error = errno;
+            close_all ();
+            return;
+          }
+      }
+  }
+  ~PerfCounters () { close_all (); }
+  PerfCounters (const PerfCounters &)            = delete;
+  PerfCounters &operator= (const PerfCounters &) = delete;
+
+  bool
+  available () const
+  {
+    return fds[0] >= 0;
+  }
+  const char *
+  why_not () const
+  {
+    return std::strerror (error);
+  }
+
+  void
+  start ()
+  {
+    ::ioctl (fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ::ioctl (fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+  // cycles, instructions, branches, branch misses
+  std::optional<std::array<std::uint64_t, 4> >
+  stop ()
+  {
+    ::ioctl (fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    std::array<std::uint64_t, 5> values{}; // the number of counters, then each one
+    if (::read (fds[0], values.data (), sizeof (values)) != sizeof (values))
+      {
+        return std::nullopt;
+      }
+    return std::array<std::uint64_t, 4>{ values[1], values[2], values[3], values[4] };
+  }
+
+private:
+  void
+  close_all ()
+  {
+    for (auto &fd : fds)
+      {
+        if (fd >= 0)
+          {
+            ::close (fd);
+          }
+        fd = -1;
+      }
+  }
+};
+
+// Which kind of blob goes where, and its seed, so every style steps the same blobs in the same order
+struct Workload
+{
+  std::vector<int>      kinds; // 0 stepper, 1 uniform, 2 Poisson
+  std::vector<unsigned> seeds;
+
+  Workload (std::size_t count, unsigned seed)
+  {
+    std::mt19937 gen (seed);
+    for (std::size_t i = 0; i < count; ++i)
+      {
+        kinds.push_back (static_cast<int> (i % 3));
+        seeds.push_back (gen ());
+      }
+    std::shuffle (kinds.begin (), kinds.end (), gen);
+  }
+};
+
+// The same two kinds of blob, dispatched at compile time through a base template
+template <typename Derived> struct CrtpBlob
+{
+  void
+  step ()
+  {
+    static_cast<Derived *> (this)->advance ();
+  }
+};
+
+struct CrtpStepper : CrtpBlob<CrtpStepper>
+{
+  int y = 0;
+  void
+  advance ()
+  {
+    y += 2;
+  }
+};
+
+template <typename U> struct CrtpRandom : CrtpBlob<CrtpRandom<U> >
+{
+  int    y = 0;
+  Engine generator;
+  U      distribution;
+  CrtpRandom (Engine gen, U dis) : generator (gen), distribution (dis) {}
+  void
+  advance ()
+  {
+    y += static_cast<int> (distribution (generator));
+  }
+};
+
+struct Report
+{
+  std::string name;
+  double      ns_per_step;
+  std::optional<std::array<std::uint64_t, 4> > counters;
+};
+
+template <typename F>
+Report
+measure (std::string name, std::size_t steps, PerfCounters &perf, F run)
+{
+  run (); // warm up
+  if (perf.available ())
+    {
+      perf.start ();
+    }
+  const auto start = std::chrono::steady_clock::now ();
+  run ();
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now () - start;
+  auto counters = perf.available () ? perf.stop () : std::nullopt;
+  return { std::move (name), elapsed.count () / static_cast<double> (steps), counters };
+}
+
+void
+print (const Report &report, std::size_t steps)
+{
+  std::cout << std::left << std::setw (28) << report.name << std::right << std::fixed << std::setprecision (2)
+            << std::setw (10) << report.ns_per_step;
+  if (report.counters)
+    {
+      const auto &[cycles, instructions, branches, misses] = *report.counters;
+      std::cout << std::setw (12) << static_cast<double> (cycles) / steps << std::setw (12)
+                << static_cast<double> (instructions) / steps << std::setw (12)
+                << (branches ? 100.0 * misses / branches : 0.0) << '%';
+    }
+  std::cout << '\n';
+}
+}
+
+int
+main (int argc, char *argv[])
+{
+  const std::size_t count = argc > 1 ? std::strtoull (argv[1], nullptr, 10) : 1'000'000;
+  const int         ticks = argc > 2 ? std::atoi (argv[2]) : 10;
+  const Workload    workload (count, 1);
+  const std::size_t steps = count * ticks;
+  PerfCounters        perf;
+  std::vector<Report> reports;
+
+  const std::uniform_int_distribution<int> uniform{ 0, 4 };
+  const auto poisson = [] () { return std::poisson_distribution<int>{ 2.0 }; };
+
+  // Virtual calls through unique_ptr, in the shuffled order and then sorted by type
+  {
+    std::vector<std::unique_ptr<Race::Blob> > blobs;
+    for (std::size_t i = 0; i < count; ++i)
+      {
+        switch (workload.kinds[i])
+          {
+          case 0:
+            blobs.push_back (std::make_unique<Race::StepperBlob> ());
+            break;
+          case 1:
+            blobs.push_back (std::make_unique<UniformBlob> (Engine{ workload.seeds[i] }, uniform));
+            break;
+          default:
+            blobs.push_back (std::make_unique<PoissonBlob> (Engine{ workload.seeds[i] }, poisson ()));
+          }
+      }
+    auto run = [&] () {
+      for (int tick = 0; tick < ticks; ++tick)
+        {
+          Race::move_blobs (blobs);
+        }
+    };
+    reports.push_back (measure ("virtual, mixed", steps, perf, run));
+    std::stable_sort (blobs.begin (), blobs.end (),
+                      [] (const auto &a, const auto &b) { return typeid (*a).before (typeid (*b)); });
+    reports.push_back (measure ("virtual, sorted by type", steps, perf, run));
+  }
+
+  // std::variant and std::visit; the blobs cannot move, so each is emplaced where it lives
+  {
+    using Variant = std::variant<Race::StepperBlob, UniformBlob, PoissonBlob>;
+    auto blobs    = std::make_unique<Variant[]> (count);
+    for (std::size_t i = 0; i < count; ++i)
+      {
+        if (workload.kinds[i] == 1)
+          {
+            blobs[i].emplace<UniformBlob> (Engine{ workload.seeds[i] }, uniform);
+          }
+        else if (workload.kinds[i] == 2)
+          {
+            blobs[i].emplace<PoissonBlob> (Engine{ workload.seeds[i] }, poisson ());
+          }
+      }
+    reports.push_back (measure ("variant + visit, mixed", steps, perf, [&] () {
+      for (int tick = 0; tick < ticks; ++tick)
+        {
+          for (std::size_t i = 0; i < count; ++i)
+            {
+              std::visit (
+                  [] (auto &blob) {
+                    using T = std::decay_t<decltype (blob)>;
+                    blob.T::step (); // a direct call, not through the vtable
+                  },
+                  blobs[i]);
+            }
+        }
+    }));
+  }
+
+  // One array per type, stepped with direct calls: CRTP blobs, then the Race blobs themselves
+  {
+    std::vector<CrtpStepper>                                       steppers;
+    std::vector<CrtpRandom<std::uniform_int_distribution<int> > > uniforms;
+    std::vector<CrtpRandom<std::poisson_distribution<int> > >     poissons;
+    for (std::size_t i = 0; i < count; ++i)
+      {
+        if (workload.kinds[i] == 0)
+          {
+            steppers.emplace_back ();
+          }
+        else if (workload.kinds[i] == 1)
+          {
+            uniforms.emplace_back (Engine{ workload.seeds[i] }, uniform);
+          }
+        else
+          {
+            poissons.emplace_back (Engine{ workload.seeds[i] }, poisson ());
+          }
+      }
+    reports.push_back (measure ("CRTP, batched by type", steps, perf, [&] () {
+      for (int tick = 0; tick < ticks; ++tick)
+        {
+          std::ranges::for_each (steppers, [] (auto &blob) { blob.step (); });
+          std::ranges::for_each (uniforms, [] (auto &blob) { blob.step (); });
+          std::ranges::for_each (poissons, [] (auto &blob) { blob.step (); });
+        }
+    }));
+  }
+  {
+    const auto kinds_of = [&] (int kind) { return std::ranges::count (workload.kinds, kind); };
+    auto       steppers = std::make_unique<Race::StepperBlob[]> (kinds_of (0));
+    // RandomBlob has no default constructor, so these sit in one buffer each, built in place
+    auto uniform_buffer = std::make_unique<std::byte[]> (sizeof (UniformBlob) * kinds_of (1));
+    auto poisson_buffer = std::make_unique<std::byte[]> (sizeof (PoissonBlob) * kinds_of (2));
+    auto uniforms       = reinterpret_cast<UniformBlob *> (uniform_buffer.get ());
+    auto poissons       = reinterpret_cast<PoissonBlob *> (poisson_buffer.get ());
+    std::size_t made_uniform = 0, made_poisson = 0;
+    for (std::size_t i = 0; i < count; ++i)
+      {
+        if (workload.kinds[i] == 1)
+          {
+            new (&uniforms[made_uniform++]) UniformBlob (Engine{ workload.seeds[i] }, uniform);
+          }
+        else if (workload.kinds[i] == 2)
+          {
+            new (&poissons[made_poisson++]) PoissonBlob (Engine{ workload.seeds[i] }, poisson ());
+          }
+      }
+    const std::size_t made_steppers = count - made_uniform - made_poisson;
+    reports.push_back (measure ("Race blobs, batched by type", steps, perf, [&] () {
+      for (int tick = 0; tick < ticks; ++tick)
+        {
+          for (std::size_t i = 0; i < made_steppers; ++i)
+            {
+              steppers[i].step (); // final, so no vtable
+            }
+          for (std::size_t i = 0; i < made_uniform; ++i)
+            {
+              uniforms[i].UniformBlob::step ();
+            }
+          for (std::size_t i = 0; i < made_poisson; ++i)
+            {
+              poissons[i].PoissonBlob::step ();
+            }
+        }
+    }));
+    std::destroy_n (uniforms, made_uniform);
+    std::destroy_n (poissons, made_poisson);
+  }
+
+  std::cout << count << " blobs (a third each stepper, uniform 0-4, Poisson 2), " << ticks << " ticks\n";
+  std::cout << std::left << std::setw (28) << "dispatch" << std::right << std::setw (10) << "ns/step";
+  if (perf.available ())
+    {
+      std::cout << std::setw (12) << "cycles/step" << std::setw (12) << "instr/step" << std::setw (13)
+                << "branch miss";
+    }
+  std::cout << '\n';
+  for (const auto &report : reports)
+    {
+      print (report, steps);
+    }
+  if (!perf.available ())
+    {
+      std::cout << "(hardware counters unavailable: " << perf.why_not ()
+                << "; see /proc/sys/kernel/perf_event_paranoid)\n";
+    }
+}
@@ -1,10 +1,26 @@
+#include <array>
 #include <cassert>
+#include <cmath>
+#include <functional>
 #include <iostream>
 #include <random>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "BlobArena.h"
+#include "BlobEngine.h"
+#include "GameLoop.h"
+#include "ParallelRace.h"
+#include "RaceLog.h"
+#include "Renderer.h"
+#include "Sampler.h"
+#include "Tournament.h"
+#include "Track.h"
 #include "Race.h"
 
 void
@@ -41,6 +57,393 @@ check_properties ()
   Race::RandomBlob random_blob ([] () { return 0; }, [] (auto gen) { return gen (); });
   random_blob.step ();
   assert (random_blob.total_steps () == 0);
+
+  // Arena blobs sit side by side and race like any others
+  {
+    Race::BlobArena arena (100 * sizeof (Race::StepperBlob), 100);
+    for (int i = 0; i < 100; ++i)
+      {
+        arena.create<Race::StepperBlob> ();
+      }
+    auto &handles = arena.blobs ();
+    assert (handles.size () == 100);
+    Race::move_blobs (handles);
+    for (std::size_t i = 1; i < handles.size (); ++i)
+      {
+        assert (handles[i]->total_steps () == 2);
+        assert (reinterpret_cast<const char *> (&*handles[i]) - reinterpret_cast<const char *> (&*handles[i - 1])
+                == sizeof (Race::StepperBlob));
+      }
+  }
+
+  // Alias tables give the same distributions as the standard ones
+  {
+    std::default_random_engine  gen{ 3 };
+    const Race::AliasTable      five = Race::AliasTable::uniform_int (0, 4);
+    std::array<int, 5>          counts{};
+    for (int i = 0; i < 50'000; ++i)
+      {
+        const int value = five (gen);
+        assert (value >= 0 && value <= 4);
+        ++counts[value];
+      }
+    for (int count : counts)
+      {
+        assert (std::abs (count - 10'000) < 500);
+      }
+    const std::array<double, 3> skewed{ 1.0, 0.0, 3.0 };
+    const Race::AliasTable      lopsided (skewed, 10);
+    int                         tens = 0;
+    for (int i = 0; i < 40'000; ++i)
+      {
+        const int value = lopsided (gen);
+        assert (value == 10 || value == 12);
+        tens += value == 10;
+      }
+    assert (std::abs (tens - 10'000) < 500);
+
+    // A RandomBlob drawing from a batch: Poisson steps with mean and variance 2
+    Race::RandomBlob poisson_blob{ std::default_random_engine{ 5 },
+                                   Race::BatchedSampler<> (Race::AliasTable::poisson (2.0)) };
+    Race::BatchedSampler<> sampler (Race::AliasTable::poisson (2.0));
+    double                 sum = 0.0, squares = 0.0;
+    const int              draws = 100'000;
+    for (int i = 0; i < draws; ++i)
+      {
+        const double value = sampler (gen);
+        sum += value;
+        squares += value * value;
+        poisson_blob.step ();
+      }
+    assert (std::abs (sum / draws - 2.0) < 0.03);
+    assert (std::abs (squares / draws - 4.0 - 2.0) < 0.1);
+    assert (std::abs (poisson_blob.total_steps () / double (draws) - 2.0) < 0.03);
+
+    // One buffer shared by a group of blobs
+    Race::BatchedSampler<> group (Race::AliasTable::uniform_int (0, 4));
+    Race::RandomBlob       first{ std::default_random_engine{ 6 }, std::ref (group) };
+    Race::RandomBlob       second{ std::default_random_engine{ 7 }, std::ref (group) };
+    first.step ();
+    second.step ();
+    assert (first.total_steps () <= 4 && second.total_steps () <= 4);
+  }
+
+  // The engine's blobs move as the blobs they stand in for
+  Race::BlobEngine engine (1);
+  assert (engine.add_steppers (3) == 0);
+  assert (engine.add_uniform (1000, 0, 4) == 3);
+  assert (engine.add_steppers (2) == 1003);
+  assert (engine.add_poisson (1000, 2.0) == 1005);
+  assert (engine.size () == 2005);
+  const int ticks = 10;
+  for (int i = 0; i < ticks; ++i)
+    {
+      engine.step ();
+    }
+  const auto positions = engine.total_steps ();
+  assert (positions[0] == 2 * ticks && positions[1004] == 2 * ticks);
+  double uniform_total = 0.0, poisson_total = 0.0;
+  for (int id = 3; id < 1003; ++id)
+    {
+      assert (positions[id] >= 0 && positions[id] <= 4 * ticks);
+      uniform_total += positions[id];
+    }
+  for (int id = 1005; id < 2005; ++id)
+    {
+      assert (positions[id] >= 0 && positions[id] == engine.total_steps (id));
+      poisson_total += positions[id];
+    }
+  // Both means are 2 a tick
+  assert (std::abs (uniform_total / 1000 / ticks - 2.0) < 0.1);
+  assert (std::abs (poisson_total / 1000 / ticks - 2.0) < 0.1);
+
+  // Known answers from the Random123 distribution
+  assert ((Race::philox ({ 0, 0, 0, 0 }, { 0, 0 })
+           == std::array<std::uint32_t, 4>{ 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 }));
+  assert ((Race::philox ({ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 })
+           == std::array<std::uint32_t, 4>{ 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }));
+
+  // The same race, whatever the number of threads
+  auto parallel_race = [] (unsigned threads) {
+    Race::ParallelRace race (42);
+    race.add_steppers (1001);
+    race.add_uniform (2000, 0, 4);
+    race.add_poisson (999, 2.0);
+    const auto result = race.run (100, 1000, threads);
+    assert (result.ticks == race.ticks () && race.size () == 4000);
+    return std::pair{ result.winners, race.total_steps () };
+  };
+  const auto one_thread = parallel_race (1);
+  assert (!one_thread.first.empty () && one_thread.second[one_thread.first[0]] >= 100);
+  assert (one_thread.second[0] < 100); // steppers plod at 2 a tick
+  assert (parallel_race (3) == one_thread);
+  assert (parallel_race (8) == one_thread);
+
+  Race::ParallelRace unfinished;
+  unfinished.add_steppers (5);
+  const auto halfway = unfinished.run (100, 10, 2);
+  assert (halfway.ticks == 10 && halfway.leader == 20 && halfway.winners.size () == 5);
+  assert (unfinished.run (100, 100).ticks == 50);
+
+  // Replaying the renderer's output on a blank screen gives the picture drawn in full
+  auto play = [] (std::vector<std::string> &screen, std::string_view bytes) {
+    std::size_t row = 0, column = 0;
+    while (!bytes.empty ())
+      {
+        if (bytes.starts_with ("\x1B[2J"))
+          {
+            screen.assign (screen.size (), std::string (screen[0].size (), ' '));
+            bytes.remove_prefix (4);
+          }
+        else if (bytes.starts_with ("\x1B["))
+          {
+            const auto end = bytes.find ('H');
+            const auto mid = bytes.find (';');
+            row            = std::stoul (std::string (bytes.substr (2, mid - 2))) - 1;
+            column         = std::stoul (std::string (bytes.substr (mid + 1, end - mid - 1))) - 1;
+            bytes.remove_prefix (end + 1);
+          }
+        else
+          {
+            screen[row][column++] = bytes.front ();
+            bytes.remove_prefix (1);
+          }
+      }
+  };
+  auto full_picture = [&] (const std::vector<int> &positions, int width) {
+    std::vector<std::string> screen (Race::TerminalRenderer::rows + 1, std::string (width, ' '));
+    Race::TerminalRenderer   fresh (-1, width);
+    play (screen, fresh.frame (positions));
+    return screen;
+  };
+  for (int width : { 80, 30 })
+    {
+      Race::TerminalRenderer   renderer (-1, width);
+      std::vector<std::string> screen (Race::TerminalRenderer::rows + 1, std::string (width, ' '));
+      std::vector<int>         positions (20);
+      std::mt19937             gen (width);
+      for (int tick = 0; tick < 12; ++tick)
+        {
+          play (screen, renderer.frame (positions));
+          assert (screen == full_picture (positions, width));
+          for (auto &y : positions)
+            {
+              y += std::uniform_int_distribution{ 0, 1 }(gen);
+            }
+        }
+      assert (renderer.frame (positions).size () > 0 && renderer.frame (positions).empty ());
+    }
+  // Twenty blobs need 43 columns, so at 30 each column shows the furthest of two
+  Race::TerminalRenderer narrow (-1, 30);
+  assert (narrow.blobs_per_column (20) == 2 && narrow.blobs_per_column (13) == 1);
+  const auto decimated = full_picture ({ 0, 9, 0, 0 }, 5);
+  assert (decimated[0] == "  *  " && decimated.back () == "     ");
+
+  // The reader always ends up with the last value published
+  Race::TripleBuffer<int> latest;
+  assert (!latest.update ());
+  latest.back () = 1;
+  latest.publish ();
+  latest.back () = 2;
+  latest.publish ();
+  assert (latest.update () && latest.front () == 2 && !latest.update ());
+  latest.back () = 3;
+  latest.publish ();
+  assert (latest.update () && latest.front () == 3);
+
+  // Fast forward, headless: every tick runs, nothing is drawn
+  std::vector<std::unique_ptr<Race::Blob> > loop_blobs;
+  loop_blobs.push_back (std::make_unique<Race::StepperBlob> ());
+  const auto headless = Race::race (loop_blobs, Race::LoopOptions{ .speed = 0.0, .max_ticks = 1000 });
+  assert (headless.ticks == 1000 && headless.frames == 0 && loop_blobs[0]->total_steps () == 2000);
+  for (const auto &rates : { Race::LoopOptions{ .tick_rate = 0.0 }, Race::LoopOptions{ .frame_rate = -1.0 } })
+    {
+      bool refused = false;
+      try
+        {
+          Race::race (loop_blobs, rates);
+        }
+      catch (const std::invalid_argument &)
+        {
+          refused = true;
+        }
+      assert (refused);
+    }
+
+  // Fifty ticks in about a tenth of a second, drawn at up to 200 frames a second; the last state is always drawn
+  std::vector<int>        last_drawn;
+  int                     steps = 0;
+  const Race::LoopOptions fast{ .tick_rate = 500.0, .frame_rate = 200.0, .max_ticks = 50 };
+  const auto rendered = Race::run_fixed_timestep ([&] () { ++steps; }, [&] (std::vector<int> &out) { out = { steps }; },
+                                                  [&] (const std::vector<int> &state) { last_drawn = state; }, fast);
+  assert (rendered.ticks == 50 && last_drawn == std::vector<int>{ 50 });
+  assert (rendered.frames >= 2 && rendered.frames <= 60);
+  assert (rendered.elapsed.count () > 0.09 && rendered.real_tick_rate () > 100.0);
+
+  // Steppers always tie; a uniform 0-4 blob matches a stepper on average
+  const Race::TournamentOptions options{ .races = 5000, .steps = 3, .threads = 3, .seed = 7 };
+  const auto tied = Race::run_tournament ({ Race::stepper_entrant (), Race::stepper_entrant () }, options);
+  assert (tied.entrants[0].wins == 0 && tied.entrants[0].ties == 5000 && tied.entrants[1].distances[6] == 5000);
+  const std::vector<Race::Entrant> mixed{ Race::stepper_entrant (), Race::uniform_entrant (0, 4),
+                                          Race::poisson_entrant (2.0) };
+  const auto                       tournament = Race::run_tournament (mixed, options);
+  std::uint64_t                    decided    = 0;
+  for (std::size_t i = 0; i < mixed.size (); ++i)
+    {
+      const auto &entrant = tournament.entrants[i];
+      decided += entrant.wins;
+      const auto [lowest, highest] = entrant.win_interval (tournament.races);
+      assert (lowest <= tournament.win_probability (i) && tournament.win_probability (i) <= highest);
+      assert (highest - lowest < 0.05);
+      assert (std::abs (entrant.mean_distance () - 6.0) < 0.2);
+    }
+  assert (decided <= tournament.races);
+
+  auto single_thread    = options;
+  single_thread.threads = 1;
+  const auto again      = Race::run_tournament (mixed, single_thread);
+  for (std::size_t i = 0; i < mixed.size (); ++i)
+    {
+      assert (again.entrants[i].wins == tournament.entrants[i].wins);
+      assert (again.entrants[i].distances == tournament.entrants[i].distances);
+    }
+
+  // Two blobs meeting head on swap velocities; one running into an obstacle bounces back
+  {
+    Race::Track track (10.0f, 0.5f, { { 5.0f, 20.0f, 1.0f } });
+    auto       &left  = track.add_blob (2.0f, 0.0f, 0.5f, 0.0f);
+    auto       &right = track.add_blob (8.0f, 0.0f, -0.5f, 0.0f);
+    auto       &up    = track.add_blob (5.0f, 16.0f, 0.0f, 1.0f);
+    bool        met   = false;
+    for (int tick = 0; tick < 8; ++tick)
+      {
+        track.tick ();
+        met = met || !track.contacts ().empty ();
+      }
+    assert (met && left.vx < 0.0f && right.vx > 0.0f && left.x < right.x);
+    assert (up.vy < 0.0f && up.y < 20.0f - 1.5f + 1e-4f);
+    Race::move_blobs (track.blobs ()); // the blobs still race as Blobs
+    assert (track.blobs ().size () == 3 && track.blobs ()[2]->total_steps () == static_cast<int> (up.y));
+  }
+
+  // On a track 32 cells across, every row of an obstacle's cells lands in the same buckets, yet a blob
+  // overlapping it still hits it just once
+  for (float dx = -0.8f; dx < 0.8f; dx += 0.1f)
+    {
+      Race::Track narrow (30.0f, 0.5f, { { 15.0f, 20.0f, 0.5f } });
+      narrow.add_blob (15.0f + dx, 19.5f, 0.0f, 0.1f);
+      narrow.tick ();
+      assert (narrow.obstacle_hits () == 1);
+    }
+
+  // The grid finds exactly the touching pairs a check of every pair finds
+  {
+    Race::Track            crowd (40.0f, 0.5f);
+    std::mt19937           gen (11);
+    std::uniform_real_distribution<float> across (0.5f, 39.5f), along (0.0f, 40.0f), speed (-0.3f, 0.3f);
+    for (int i = 0; i < 1500; ++i)
+      {
+        crowd.add_blob (across (gen), along (gen), speed (gen), speed (gen));
+      }
+    for (int tick = 0; tick < 3; ++tick)
+      {
+        // Positions after the move, before any collision is settled
+        std::vector<std::pair<float, float> > moved;
+        for (auto &blob : crowd.blobs ())
+          {
+            const auto &mover = static_cast<const Race::MovingBlob &> (*blob);
+            moved.emplace_back (mover.x + mover.vx, mover.y + mover.vy);
+          }
+        crowd.tick ();
+        std::size_t expected = 0;
+        for (std::size_t i = 0; i < moved.size (); ++i)
+          {
+            for (std::size_t j = i + 1; j < moved.size (); ++j)
+              {
+                const float dx = moved[j].first - moved[i].first, dy = moved[j].second - moved[i].second;
+                expected += dx * dx + dy * dy < 1.0f;
+              }
+          }
+        assert (crowd.contacts ().size () == expected && expected > 0);
+      }
+  }
+
+  // A recorded race replays tick for tick, from the start or from anywhere, in about a byte a blob a tick
+  {
+    std::vector<std::unique_ptr<Race::Blob> > racers;
+    for (unsigned i = 0; i < 20; ++i)
+      {
+        racers.emplace_back (std::make_unique<Race::RandomBlob<std::mt19937, std::uniform_int_distribution<int> > > (
+            std::mt19937{ i }, std::uniform_int_distribution{ 0, 4 }));
+      }
+    std::stringstream              log;
+    std::vector<std::vector<int> > expected;
+    {
+      Race::RaceRecorder recorder (log, 16);
+      for (int tick = 0; tick < 500; ++tick)
+        {
+          Race::move_blobs (racers, recorder);
+          auto &positions = expected.emplace_back ();
+          for (const auto &racer : racers)
+            {
+              positions.push_back (racer->total_steps ());
+            }
+        }
+    }
+    assert (log.str ().size () < expected.size () * racers.size () * 11 / 10 + 100);
+
+    Race::RaceReplay replay (log);
+    assert (replay.ticks () == expected.size () && replay.blobs () == racers.size ());
+    for (const auto &positions : expected)
+      {
+        assert (replay.next () == positions);
+      }
+    std::mt19937                                 gen (5);
+    std::uniform_int_distribution<std::uint64_t> any_tick (0, expected.size () - 1);
+    for (int i = 0; i < 200; ++i)
+      {
+        const auto tick = any_tick (gen);
+        assert (replay.seek (tick) == expected[tick] && replay.tick () == tick);
+      }
+
+    // Drawn from positions, the picture is the one the blobs themselves draw
+    std::ostringstream from_blobs, from_replay;
+    auto              *screen = std::cout.rdbuf (from_blobs.rdbuf ());
+    Race::draw_blobs (racers);
+    std::cout.rdbuf (from_replay.rdbuf ());
+    Race::draw_blobs (replay.seek (expected.size () - 1));
+    std::cout.rdbuf (screen);
+    assert (from_blobs.str () == from_replay.str ());
+
+    // A stream that fails throws from finish, but never from the destructor
+    struct Refusing : std::streambuf
+    {
+      int_type
+      overflow (int_type) override
+      {
+        return traits_type::eof ();
+      }
+    };
+    Refusing     refusing;
+    std::ostream nowhere (&refusing);
+    nowhere.exceptions (std::ios::badbit);
+    bool thrown = false;
+    {
+      Race::RaceRecorder unfinished (nowhere);
+      unfinished.record (std::vector<int>{ 1, 2 });
+    }
+    try
+      {
+        Race::RaceRecorder recorder (nowhere);
+        recorder.record (std::vector<int>{ 1, 2 });
+        recorder.finish ();
+      }
+    catch (const std::ios::failure &)
+      {
+        thrown = true;
+      }
+    assert (thrown);
+  }
 }
 
 // Listing 6.8 A warm up race
@@ -57,21 +460,19 @@ race_steppers ()
     }
 }
 
-// Listing 6.18 Create blobs for a proper race
-std::vector<std::unique_ptr<Race::Blob> >
-create_blobs (int number)
+// The same blobs, all from one arena; one random_device draw seeds every engine
+std::vector<Race::BlobHandle> &
+create_blobs (int number, Race::BlobArena &arena)
 {
   using namespace Race;
-  std::vector<std::unique_ptr<Blob> > blobs;
-  std::random_device                  rd;
+  using UniformBlob = RandomBlob<std::default_random_engine, std::uniform_int_distribution<int> >;
+  std::default_random_engine seeds{ std::random_device{}() };
   for (int i = 0; i < number / 2; ++i)
     {
-      blobs.emplace_back (std::make_unique<StepperBlob> ());
-      blobs.emplace_back (
-          std::make_unique<RandomBlob<std::default_random_engine, std::uniform_int_distribution<int> > > (
-              std::default_random_engine{ rd () }, std::uniform_int_distribution{ 0, 4 }));
+      arena.create<StepperBlob> ();
+      arena.create<UniformBlob> (std::default_random_engine{ seeds () }, std::uniform_int_distribution{ 0, 4 });
     }
-  return blobs;
+  return arena.blobs ();
 }
 
 int
@@ -87,7 +488,14 @@ main ()
   // std::vector<Race::StepperBlob> blobs(4);
   // Race::race(blobs);
 
-  // Listing 6.19 A proper race
-  auto blobs = create_blobs (8);
-  Race::race (blobs);
+  // Listing 6.19 A proper race, redrawing only what changes on a fixed timestep
+  auto                   blobs = Race::create_blobs (8);
+  Race::TerminalRenderer renderer;
+  const auto             stats = Race::race (blobs, renderer, Race::LoopOptions{});
+  std::cout << stats.ticks << " ticks at " << stats.real_tick_rate () << " a second, " << stats.frames << " frames, "
+            << stats.dropped_frames << " dropped, worst frame " << stats.worst_frame_time.count () * 1e3 << "ms\n";
+
+  // Listing 6.15 again, with every blob carved from one arena
+  Race::BlobArena arena;
+  Race::race (create_blobs (8, arena));
 }
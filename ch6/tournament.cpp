@@ -0,0 +1,28 @@
+// Headless races between a stepper and random blobs, for tuning blob parameters.
+// A separate program from main.cpp: build it with Race.cpp and Tournament.cpp.
+#include <cstdlib>
+#include <iostream>
+
+#include "Tournament.h"
+
+int
+main (int argc, char *argv[])
+{
+  Race::TournamentOptions options;
+  if (argc > 1)
+    {
+      options.races = std::strtoull (argv[1], nullptr, 10);
+    }
+  if (argc > 2)
+    {
+      options.steps = std::atoi (argv[2]);
+    }
+  if (argc > 3)
+    {
+      options.threads = static_cast<unsigned> (std::atoi (argv[3]));
+    }
+
+  const std::vector<Race::Entrant> entrants{ Race::stepper_entrant (), Race::uniform_entrant (0, 4),
+                                             Race::poisson_entrant (2.0) };
+  std::cout << Race::run_tournament (entrants, options);
+}
@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <cassert>
+
+#include "FlatDictionary.h"
+
+namespace
+{
+// Compares a key cut to the prefix's length with the prefix, either way round, as std::equal_range needs
+struct ComparePrefix
+{
+  bool
+  operator() (const smashing::FlatDictionary::value_type &entry, std::string_view prefix) const
+  {
+    return entry.first.substr (0, prefix.size ()) < prefix;
+  }
+  bool
+  operator() (std::string_view prefix, const smashing::FlatDictionary::value_type &entry) const
+  {
+    return prefix < entry.first.substr (0, prefix.size ());
+  }
+};
+}
+
+std::string_view
+smashing::FlatDictionary::append (std::string_view text)
+{
+  const auto start = arena.size ();
+  arena.insert (arena.end (), text.begin (), text.end ());
+  return { arena.data () + start, text.size () };
+}
+
+void
+smashing::FlatDictionary::sort ()
+{
+  std::ranges::stable_sort (entries, {}, &value_type::first);
+}
+
+smashing::FlatDictionary
+smashing::FlatDictionary::from_sorted (std::vector<value_type> entries, std::shared_ptr<const void> backing)
+{
+  assert (std::ranges::is_sorted (entries, {}, &value_type::first));
+  FlatDictionary dictionary;
+  dictionary.entries = std::move (entries);
+  dictionary.backing = std::move (backing);
+  return dictionary;
+}
+
+smashing::FlatDictionary::const_iterator
+smashing::FlatDictionary::lower_bound (std::string_view key) const
+{
+  return std::ranges::lower_bound (entries, key, {}, &value_type::first);
+}
+
+smashing::FlatDictionary::const_iterator
+smashing::FlatDictionary::upper_bound (std::string_view key) const
+{
+  return std::ranges::upper_bound (entries, key, {}, &value_type::first);
+}
+
+std::pair<smashing::FlatDictionary::const_iterator, smashing::FlatDictionary::const_iterator>
+smashing::FlatDictionary::equal_range (std::string_view key) const
+{
+  return { lower_bound (key), upper_bound (key) };
+}
+
+std::pair<smashing::FlatDictionary::const_iterator, smashing::FlatDictionary::const_iterator>
+smashing::FlatDictionary::prefix_range (std::string_view prefix) const
+{
+  return std::equal_range (entries.begin (), entries.end (), prefix, ComparePrefix{});
+}
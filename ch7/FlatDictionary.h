@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <ranges>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace smashing
+{
+// Keys and definitions in one block of chars (or storage it keeps alive, such as a mapped file),
+// with a sorted array of views into it.
+// A look up is a binary search over contiguous memory and takes a string_view, so a caller never
+// builds a std::string just to ask.
+class FlatDictionary
+{
+public:
+  using value_type     = std::pair<std::string_view, std::string_view>;
+  using const_iterator = std::vector<value_type>::const_iterator;
+
+private:
+  std::vector<char>           arena;   // moving a vector keeps its buffer, so the views survive a move
+  std::vector<value_type>     entries; // sorted by key; equal keys stay in the order given
+  std::shared_ptr<const void> backing; // anything else the views point into, such as a mapped file
+
+  template <typename R>
+  void
+  fill (const R &items)
+  {
+    std::size_t chars = 0;
+    std::size_t count = 0;
+    for (const auto &[key, definition] : items)
+      {
+        chars += std::string_view (key).size () + std::string_view (definition).size ();
+        ++count;
+      }
+    arena.reserve (chars); // never grows past this, so views taken as it fills stay valid
+    entries.reserve (count);
+    for (const auto &[key, definition] : items)
+      {
+        entries.emplace_back (append (key), append (definition));
+      }
+    sort ();
+  }
+  std::string_view append (std::string_view text);
+  void             sort ();
+
+public:
+  FlatDictionary () = default;
+  FlatDictionary (std::initializer_list<value_type> items) { fill (items); }
+  // From pairs of anything a string_view can be made from, such as a multimap of strings
+  template <std::ranges::forward_range R>
+    requires requires (std::ranges::range_reference_t<const R> item) {
+      std::string_view (item.first);
+      std::string_view (item.second);
+    }
+  explicit FlatDictionary (const R &items)
+  {
+    fill (items);
+  }
+
+  // Adopts views into storage owned by backing instead of copying them; entries must already be sorted by key
+  static FlatDictionary from_sorted (std::vector<value_type> entries, std::shared_ptr<const void> backing);
+
+  // The views point into this dictionary's arena
+  FlatDictionary (const FlatDictionary &)            = delete;
+  FlatDictionary &operator= (const FlatDictionary &) = delete;
+  FlatDictionary (FlatDictionary &&)                 = default;
+  FlatDictionary &operator= (FlatDictionary &&)      = default;
+
+  const_iterator
+  begin () const
+  {
+    return entries.begin ();
+  }
+  const_iterator
+  end () const
+  {
+    return entries.end ();
+  }
+  std::size_t
+  size () const
+  {
+    return entries.size ();
+  }
+  bool
+  empty () const
+  {
+    return entries.empty ();
+  }
+
+  const_iterator                            lower_bound (std::string_view key) const;
+  const_iterator                            upper_bound (std::string_view key) const;
+  std::pair<const_iterator, const_iterator> equal_range (std::string_view key) const;
+  // Every key starting with prefix: equal_range with each key cut to the prefix's length
+  std::pair<const_iterator, const_iterator> prefix_range (std::string_view prefix) const;
+};
+}
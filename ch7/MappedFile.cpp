@@ -0,0 +1,46 @@
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+
+smashing::MappedFile::MappedFile (const std::string &filename)
+{
+  const int fd = ::open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      throw std::runtime_error ("Failed to open " + filename);
+    }
+  struct stat status;
+  if (::fstat (fd, &status) != 0)
+    {
+      ::close (fd);
+      throw std::runtime_error ("Failed to open " + filename);
+    }
+  length = static_cast<std::size_t> (status.st_size);
+  if (length == 0)
+    {
+      // mmap refuses an empty mapping, and there is nothing to map anyway
+      ::close (fd);
+      return;
+    }
+  void *start = ::mmap (nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close (fd);
+  if (start == MAP_FAILED)
+    {
+      throw std::runtime_error ("Failed to map " + filename);
+    }
+  ::madvise (start, length, MADV_SEQUENTIAL);
+  data = static_cast<const char *> (start);
+}
+
+smashing::MappedFile::~MappedFile ()
+{
+  if (data)
+    {
+      ::munmap (const_cast<char *> (data), length);
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace smashing
+{
+// A whole file mapped read only, for as long as this lives
+class MappedFile
+{
+  const char *data   = nullptr;
+  std::size_t length = 0;
+
+public:
+  // Throws std::runtime_error if the file cannot be opened or mapped
+  explicit MappedFile (const std::string &filename);
+  ~MappedFile ();
+
+  MappedFile (const MappedFile &)            = delete;
+  MappedFile &operator= (const MappedFile &) = delete;
+
+  std::string_view
+  text () const
+  {
+    return { data, length };
+  }
+};
+}
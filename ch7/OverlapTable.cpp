@@ -0,0 +1,74 @@
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "OverlapTable.h"
+#include "PrefixTrie.h"
+
+smashing::OverlapTable::OverlapTable (const FlatDictionary &keywords, const FlatDictionary &dictionary)
+{
+  using NodeId = PrefixTrie::NodeId;
+  const PrefixTrie trie (dictionary);
+
+  // Breadth first, a node's failure link only ever points at a shallower node, which already has its own
+  std::vector<NodeId>        fail (trie.node_count (), PrefixTrie::root);
+  std::vector<std::uint32_t> depth (trie.node_count (), 0);
+  auto                       step = [&] (NodeId state, char c) {
+    for (;;)
+      {
+        const NodeId next = trie.child (state, c);
+        if (next != PrefixTrie::no_node)
+          {
+            return next;
+          }
+        if (state == PrefixTrie::root)
+          {
+            return PrefixTrie::root;
+          }
+        state = fail[state];
+      }
+  };
+  for (NodeId node = 0; node < trie.node_count (); ++node)
+    {
+      const auto [first, last] = trie.children (node);
+      for (auto child = first; child < last; ++child)
+        {
+          depth[child] = depth[node] + 1;
+          fail[child]  = node == PrefixTrie::root ? PrefixTrie::root : step (fail[node], trie.label (child));
+        }
+    }
+
+  starts.reserve (keywords.size () + 1);
+  starts.push_back (0);
+  for (const auto &[keyword, definition] : keywords)
+    {
+      NodeId state = PrefixTrie::root;
+      for (const char c : keyword)
+        {
+          state = step (state, c);
+        }
+      // The whole keyword is not an overlap with itself, so start at offset 1
+      for (; state != PrefixTrie::root; state = fail[state])
+        {
+          if (depth[state] < keyword.size ())
+            {
+              const auto [lb, ub] = trie.words_below (state);
+              overlaps.push_back ({ static_cast<std::uint32_t> (keyword.size () - depth[state]),
+                                    static_cast<std::uint32_t> (lb - dictionary.begin ()),
+                                    static_cast<std::uint32_t> (ub - lb) });
+            }
+        }
+      if (overlaps.size () >= std::numeric_limits<std::uint32_t>::max ())
+        {
+          throw std::length_error ("Too many overlaps for an OverlapTable");
+        }
+      starts.push_back (static_cast<std::uint32_t> (overlaps.size ()));
+    }
+}
+
+std::size_t
+smashing::OverlapTable::puzzles () const
+{
+  return std::accumulate (overlaps.begin (), overlaps.end (), std::size_t{ 0 },
+                          [] (std::size_t total, const Overlap &overlap) { return total + overlap.count; });
+}
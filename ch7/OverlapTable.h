@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "FlatDictionary.h"
+
+namespace smashing
+{
+// Every way every keyword runs into a dictionary word, worked out up front rather than offset by offset.
+// The dictionary's keys make an Aho-Corasick automaton: its trie, plus a failure link from each node to the
+// node for the longest proper suffix of its chars which is also in the trie. Reading a keyword through it
+// ends on the longest suffix of the keyword that starts a word, and the failure links from there give each
+// shorter one, so a keyword costs one pass over its chars plus one step per overlap found.
+// The words starting with a suffix are a run of the sorted dictionary, so an overlap is stored as that run:
+// a table of runs, keyword by keyword, in a single array.
+class OverlapTable
+{
+public:
+  // keyword.substr (offset) starts the words from first up to first + count of the dictionary
+  struct Overlap
+  {
+    std::uint32_t offset;
+    std::uint32_t first;
+    std::uint32_t count;
+  };
+
+private:
+  std::vector<std::uint32_t> starts; // keyword k's overlaps are overlaps[starts[k]] up to overlaps[starts[k + 1]]
+  std::vector<Overlap>       overlaps;
+
+public:
+  OverlapTable (const FlatDictionary &keywords, const FlatDictionary &dictionary);
+
+  // Keyword k's overlaps, shortest offset first, as select_overlapping_word_from_dictionary tries them
+  std::span<const Overlap>
+  operator[] (std::size_t keyword) const
+  {
+    return { overlaps.data () + starts[keyword], overlaps.data () + starts[keyword + 1] };
+  }
+  std::size_t
+  keywords () const
+  {
+    return starts.size () - 1;
+  }
+  // How many (keyword, offset, word) there are in all
+  std::size_t puzzles () const;
+};
+}
@@ -0,0 +1,109 @@
+#include <limits>
+#include <stdexcept>
+
+#include "PrefixTrie.h"
+
+smashing::PrefixTrie::PrefixTrie (const FlatDictionary &words) : words (&words)
+{
+  if (words.size () >= std::numeric_limits<std::uint32_t>::max ())
+    {
+      throw std::length_error ("Too many words for a PrefixTrie");
+    }
+  nodes.push_back ({ 0, 0, 0, static_cast<std::uint32_t> (words.size ()) });
+  labels.push_back ('\0');
+
+  // Breadth first: the words below a node at depth d share d chars, so their d-th chars split them into
+  // runs, one per child. Words of exactly d chars end at the node and sort before the rest.
+  const auto                 entries = words.begin ();
+  std::vector<std::uint32_t> depths{ 0 };
+  for (std::size_t i = 0; i < nodes.size (); ++i)
+    {
+      const std::uint32_t depth = depths[i];
+      std::uint32_t       next  = nodes[i].first;
+      const std::uint32_t last  = nodes[i].first + nodes[i].count;
+      while (next < last && entries[next].first.size () == depth)
+        {
+          ++next;
+        }
+      nodes[i].first_child = static_cast<std::uint32_t> (nodes.size ());
+      while (next < last)
+        {
+          const char    label = entries[next].first[depth];
+          std::uint32_t end   = next + 1;
+          while (end < last && entries[end].first[depth] == label)
+            {
+              ++end;
+            }
+          nodes.push_back ({ 0, 0, next, end - next });
+          labels.push_back (label);
+          depths.push_back (depth + 1);
+          ++nodes[i].children;
+          next = end;
+        }
+    }
+}
+
+smashing::PrefixTrie::NodeId
+smashing::PrefixTrie::child (std::span<const Node> nodes, std::span<const char> labels, NodeId node, char label)
+{
+  const auto last = nodes[node].first_child + nodes[node].children;
+  for (auto at = nodes[node].first_child; at < last; ++at)
+    {
+      if (labels[at] == label)
+        {
+          return at;
+        }
+    }
+  return no_node;
+}
+
+smashing::PrefixTrie::NodeId
+smashing::PrefixTrie::find (std::span<const Node> nodes, std::span<const char> labels, std::string_view prefix)
+{
+  NodeId node = root;
+  for (const char c : prefix)
+    {
+      node = child (nodes, labels, node, c);
+      if (node == no_node)
+        {
+          return no_node;
+        }
+    }
+  return node;
+}
+
+std::pair<smashing::PrefixTrie::const_iterator, smashing::PrefixTrie::const_iterator>
+smashing::PrefixTrie::words_below (NodeId node) const
+{
+  const auto first = words->begin () + nodes[node].first;
+  return { first, first + nodes[node].count };
+}
+
+std::pair<smashing::PrefixTrie::const_iterator, smashing::PrefixTrie::const_iterator>
+smashing::PrefixTrie::prefix_range (std::string_view prefix) const
+{
+  const auto node = find (nodes, labels, prefix);
+  if (node == no_node)
+    {
+      return { words->end (), words->end () };
+    }
+  return words_below (node);
+}
+
+std::size_t
+smashing::PrefixTrie::count (std::string_view prefix) const
+{
+  const auto node = find (nodes, labels, prefix);
+  return node == no_node ? 0 : nodes[node].count;
+}
+
+smashing::PrefixTrie::const_iterator
+smashing::PrefixTrie::nth (std::string_view prefix, std::size_t rank) const
+{
+  const auto node = find (nodes, labels, prefix);
+  if (node == no_node || rank >= nodes[node].count)
+    {
+      return words->end ();
+    }
+  return words->begin () + nodes[node].first + static_cast<std::ptrdiff_t> (rank);
+}
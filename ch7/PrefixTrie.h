@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "FlatDictionary.h"
+
+namespace smashing
+{
+// A trie over the keys of a FlatDictionary, for finding the words which start with a prefix in time that
+// depends on the prefix, not on how many words there are.
+// The nodes sit in one array, breadth first, so each node's children are side by side and need no pointers.
+// Because the dictionary is sorted, the words below any node are a run of it: a node keeps where the run
+// starts and how many words are in it, which picks the nth word with a given prefix straight away.
+// The trie refers to the dictionary, which must outlive it.
+class PrefixTrie
+{
+public:
+  using const_iterator = FlatDictionary::const_iterator;
+  using NodeId         = std::uint32_t;
+
+  struct Node
+  {
+    std::uint32_t first_child;
+    std::uint32_t children;
+    std::uint32_t first; // the first word below, as an index into the dictionary
+    std::uint32_t count; // the words below, this one's own included
+  };
+
+  static constexpr NodeId root    = 0;
+  static constexpr NodeId no_node = std::numeric_limits<NodeId>::max ();
+
+private:
+  const FlatDictionary *words;
+  std::vector<Node>     nodes;
+  std::vector<char>     labels; // the char on the edge into each node; the root's is unused
+
+public:
+  explicit PrefixTrie (const FlatDictionary &words);
+
+  std::size_t
+  node_count () const
+  {
+    return nodes.size ();
+  }
+
+  // Every word starting with prefix
+  std::pair<const_iterator, const_iterator> prefix_range (std::string_view prefix) const;
+  std::size_t                               count (std::string_view prefix) const;
+  // The rank-th word starting with prefix, or the dictionary's end if there are not that many
+  const_iterator nth (std::string_view prefix, std::size_t rank) const;
+
+  // Node by node, for walks of the trie's own: nodes are numbered breadth first, so parents come before children
+  NodeId
+  child (NodeId node, char label) const
+  {
+    return child (nodes, labels, node, label);
+  }
+  // The children of node are the nodes from first up to last
+  std::pair<NodeId, NodeId>
+  children (NodeId node) const
+  {
+    return { nodes[node].first_child, nodes[node].first_child + nodes[node].children };
+  }
+  char
+  label (NodeId node) const
+  {
+    return labels[node];
+  }
+  // The words starting with the chars on the way to node
+  std::pair<const_iterator, const_iterator> words_below (NodeId node) const;
+
+  // The arrays as they are, and walks over them, for a trie kept somewhere else such as a snapshot
+  std::span<const Node>
+  node_array () const
+  {
+    return nodes;
+  }
+  std::span<const char>
+  label_array () const
+  {
+    return labels;
+  }
+  static NodeId child (std::span<const Node> nodes, std::span<const char> labels, NodeId node, char label);
+  // The node for prefix, or no_node
+  static NodeId find (std::span<const Node> nodes, std::span<const char> labels, std::string_view prefix);
+};
+}
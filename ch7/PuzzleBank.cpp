@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+
+#include "OverlapTable.h"
+#include "PuzzleBank.h"
+
+namespace
+{
+constexpr char          magic[8]       = { 'S', 'M', 'A', 'S', 'H', 'P', 'Z', 'L' };
+constexpr std::uint32_t version        = 1;
+constexpr std::size_t   shard_keywords = 64;
+constexpr std::size_t   shards_ahead   = 4; // per thread, of the next shard to be written
+
+// The puzzles for a run of keywords, made into text ready to write
+struct Shard
+{
+  std::string              text;
+  std::vector<std::size_t> ends;    // where each puzzle's text ends, when deduplicating
+  std::vector<std::string> answers; // and its answer
+  std::size_t              puzzles = 0;
+  bool                     ready   = false;
+};
+
+void
+append_u32 (std::string &text, std::uint32_t value)
+{
+  for (int shift = 0; shift < 32; shift += 8)
+    {
+      text += static_cast<char> ((value >> shift) & 0xff);
+    }
+}
+
+void
+append_binary (std::string &text, std::string_view value)
+{
+  append_u32 (text, static_cast<std::uint32_t> (value.size ()));
+  text += value;
+}
+
+void
+append_json (std::string &text, std::string_view value)
+{
+  constexpr char hex[] = "0123456789abcdef";
+  text += '"';
+  for (const char c : value)
+    {
+      switch (c)
+        {
+        case '"':
+          text += "\\\"";
+          break;
+        case '\\':
+          text += "\\\\";
+          break;
+        case '\n':
+          text += "\\n";
+          break;
+        case '\r':
+          text += "\\r";
+          break;
+        case '\t':
+          text += "\\t";
+          break;
+        default:
+          if (static_cast<unsigned char> (c) < 0x20)
+            {
+              text += "\\u00";
+              text += hex[c >> 4];
+              text += hex[c & 0xf];
+            }
+          else
+            {
+              text += c;
+            }
+        }
+    }
+  text += '"';
+}
+
+void
+make_shard (Shard &shard, std::size_t first, std::size_t last, const smashing::OverlapTable &overlaps,
+            const smashing::FlatDictionary &keywords, const smashing::FlatDictionary &dictionary,
+            const smashing::PuzzleBankOptions &options)
+{
+  std::string answer;
+  for (auto k = first; k < last; ++k)
+    {
+      const auto &[keyword, definition] = *(keywords.begin () + static_cast<std::ptrdiff_t> (k));
+      for (const auto &overlap : overlaps[k])
+        {
+          const auto start = dictionary.begin () + overlap.first;
+          for (auto it = start; it != start + overlap.count; ++it)
+            {
+              const auto &[word, word_definition] = *it;
+              answer.assign (keyword.substr (0, overlap.offset));
+              answer += word;
+              if (options.format == smashing::PuzzleFormat::binary)
+                {
+                  append_u32 (shard.text, overlap.offset);
+                  append_binary (shard.text, keyword);
+                  append_binary (shard.text, word);
+                  append_binary (shard.text, answer);
+                  append_binary (shard.text, definition);
+                  append_binary (shard.text, word_definition);
+                }
+              else
+                {
+                  shard.text += "{\"first_word\":";
+                  append_json (shard.text, keyword);
+                  shard.text += ",\"second_word\":";
+                  append_json (shard.text, word);
+                  shard.text += ",\"offset\":" + std::to_string (overlap.offset) + ",\"answer\":";
+                  append_json (shard.text, answer);
+                  shard.text += ",\"first_definition\":";
+                  append_json (shard.text, definition);
+                  shard.text += ",\"second_definition\":";
+                  append_json (shard.text, word_definition);
+                  shard.text += "}\n";
+                }
+              ++shard.puzzles;
+              if (options.deduplicate)
+                {
+                  shard.ends.push_back (shard.text.size ());
+                  shard.answers.push_back (answer);
+                }
+            }
+        }
+    }
+}
+
+std::uint32_t
+read_u32 (std::istream &in)
+{
+  unsigned char bytes[4];
+  if (!in.read (reinterpret_cast<char *> (bytes), sizeof bytes))
+    {
+      throw std::runtime_error ("Puzzle bank ends part way through a puzzle");
+    }
+  return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<std::uint32_t> (bytes[3]) << 24;
+}
+
+std::string
+read_string (std::istream &in)
+{
+  std::string value (read_u32 (in), '\0');
+  if (!in.read (value.data (), static_cast<std::streamsize> (value.size ())))
+    {
+      throw std::runtime_error ("Puzzle bank ends part way through a puzzle");
+    }
+  return value;
+}
+}
+
+std::size_t
+smashing::write_puzzle_bank (std::ostream &out, const FlatDictionary &keywords, const FlatDictionary &dictionary,
+                             const PuzzleBankOptions &options)
+{
+  const OverlapTable overlaps (keywords, dictionary);
+  if (options.format == PuzzleFormat::binary)
+    {
+      std::string header (magic, sizeof magic);
+      append_u32 (header, version);
+      append_u32 (header, 0);
+      out.write (header.data (), static_cast<std::streamsize> (header.size ()));
+    }
+
+  const unsigned threads = options.threads ? options.threads : std::max (1u, std::thread::hardware_concurrency ());
+  const std::size_t       count = (keywords.size () + shard_keywords - 1) / shard_keywords;
+  std::vector<Shard>      shards (count);
+  std::mutex              guard;
+  std::condition_variable changed;
+  std::size_t             claimed = 0; // shards a worker has started
+  std::size_t             written = 0;     // shards out of the way, whose memory is freed
+  bool                    stopped = false; // the writer gave up, so the workers should too
+  auto                    work    = [&] {
+    for (;;)
+      {
+        std::size_t shard;
+        {
+          std::unique_lock lock (guard);
+          changed.wait (lock, [&] {
+            return stopped || claimed == count || claimed < written + threads * shards_ahead;
+          });
+          if (stopped || claimed == count)
+            {
+              return;
+            }
+          shard = claimed++;
+        }
+        const auto first = shard * shard_keywords;
+        make_shard (shards[shard], first, std::min (first + shard_keywords, keywords.size ()), overlaps, keywords,
+                    dictionary, options);
+        {
+          std::lock_guard lock (guard);
+          shards[shard].ready = true;
+        }
+        changed.notify_all ();
+      }
+  };
+
+  // This thread only writes, in order, so a stalled stream holds up the workers rather than filling memory
+  std::size_t                     puzzles = 0;
+  std::unordered_set<std::string> answers;
+  {
+    std::vector<std::jthread> workers;
+    for (unsigned i = 0; i < threads; ++i)
+      {
+        workers.emplace_back (work);
+      }
+    // If writing throws, the workers waiting for room must be let go before they are joined
+    try
+      {
+        for (std::size_t s = 0; s < count; ++s)
+          {
+            {
+              std::unique_lock lock (guard);
+              changed.wait (lock, [&] { return shards[s].ready; });
+            }
+            Shard &shard = shards[s];
+            if (!options.deduplicate)
+              {
+                out.write (shard.text.data (), static_cast<std::streamsize> (shard.text.size ()));
+                puzzles += shard.puzzles;
+              }
+            else
+              {
+                // Each run of new answers goes out in one write, up to the next repeat
+                std::size_t from = 0;
+                for (std::size_t i = 0; i < shard.ends.size (); ++i)
+                  {
+                    const std::size_t start = i == 0 ? 0 : shard.ends[i - 1];
+                    if (answers.insert (std::move (shard.answers[i])).second)
+                      {
+                        ++puzzles;
+                      }
+                    else
+                      {
+                        out.write (shard.text.data () + from, static_cast<std::streamsize> (start - from));
+                        from = shard.ends[i];
+                      }
+                  }
+                out.write (shard.text.data () + from, static_cast<std::streamsize> (shard.text.size () - from));
+              }
+            shard = {};
+            {
+              std::lock_guard lock (guard);
+              written = s + 1;
+            }
+            changed.notify_all ();
+          }
+      }
+    catch (...)
+      {
+        {
+          std::lock_guard lock (guard);
+          stopped = true;
+        }
+        changed.notify_all ();
+        throw;
+      }
+  }
+  if (!out)
+    {
+      throw std::runtime_error ("Failed to write puzzle bank");
+    }
+  return puzzles;
+}
+
+std::vector<smashing::Puzzle>
+smashing::read_puzzle_bank (std::istream &in)
+{
+  char header[16];
+  if (!in.read (header, sizeof header) || !std::equal (std::begin (magic), std::end (magic), header))
+    {
+      throw std::runtime_error ("Not a puzzle bank");
+    }
+  if (header[8] != static_cast<char> (version) || header[9] || header[10] || header[11])
+    {
+      throw std::runtime_error ("Puzzle bank is not version " + std::to_string (version));
+    }
+  std::vector<Puzzle> puzzles;
+  while (in.peek () != std::istream::traits_type::eof ())
+    {
+      Puzzle puzzle;
+      puzzle.offset            = static_cast<int> (read_u32 (in));
+      puzzle.first_word        = read_string (in);
+      puzzle.second_word       = read_string (in);
+      puzzle.answer            = read_string (in);
+      puzzle.first_definition  = read_string (in);
+      puzzle.second_definition = read_string (in);
+      puzzles.push_back (std::move (puzzle));
+    }
+  return puzzles;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "FlatDictionary.h"
+
+namespace smashing
+{
+// One answer smash puzzle: first_word.substr (0, offset) + second_word makes the answer
+struct Puzzle
+{
+  std::string first_word;
+  std::string second_word;
+  int         offset = 0;
+  std::string answer;
+  std::string first_definition;
+  std::string second_definition;
+
+  bool operator== (const Puzzle &) const = default;
+};
+
+enum class PuzzleFormat
+{
+  jsonl,  // one object per line, with the fields named as in Puzzle
+  binary, // "SMASHPZL", u32 version, u32 zero, then per puzzle a u32 offset and each string as a u32 length
+          // and its bytes: first word, second word, answer, first definition, second definition; little endian
+};
+
+struct PuzzleBankOptions
+{
+  PuzzleFormat format      = PuzzleFormat::jsonl;
+  bool         deduplicate = false; // only the first puzzle with each answer
+  unsigned     threads     = 0;     // 0 uses one per core
+};
+
+// Writes every puzzle there is, keyword by keyword in dictionary order, then shortest offset first, then by
+// second word, as an OverlapTable lists them. Shards of keywords are made into text on separate threads and
+// written in order as each is ready, so the output is the same however many threads run.
+// Deduplicating keeps every answer written so far in memory.
+// Returns how many puzzles were written; throws std::runtime_error if out fails.
+std::size_t write_puzzle_bank (std::ostream &out, const FlatDictionary &keywords, const FlatDictionary &dictionary,
+                               const PuzzleBankOptions &options = {});
+
+// Reads back a bank written as PuzzleFormat::binary.
+// Throws std::runtime_error if it is not one, or stops part way through a puzzle.
+std::vector<Puzzle> read_puzzle_bank (std::istream &in);
+}
@@ -1,8 +1,13 @@
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <random>
+#include <stdexcept>
+#include <thread>
 
+#include "MappedFile.h"
 #include "Smash.h"
 
 // Listing 7.9 Transform a string to lower case
@@ -14,12 +19,14 @@ str_tolower (std::string s)
   return s;
 }
 
-// Listing 7.10 Load a file into a multimap
-std::multimap<std::string, std::string>
-smashing::load_dictionary (const std::string &filename)
+namespace
 {
-  std::multimap<std::string, std::string> dictionary;
-  std::ifstream                           infile{ filename };
+// Listing 7.10 Load a file into a multimap, with what to do with each entry left to the caller
+template <typename F>
+void
+read_dictionary (const std::string &filename, F add)
+{
+  std::ifstream infile{ filename };
   if (infile)
     {
       std::string line;
@@ -31,8 +38,7 @@ smashing::load_dictionary (const std::string &filename)
               std::string key{ line.substr (0, position) };
               std::string value{ line.substr (position + 1) };
               key = str_tolower (key);
-              // dictionary.insert({ key, value }); or
-              dictionary.emplace (key, value);
+              add (std::move (key), std::move (value));
             }
           else
             {
@@ -45,9 +51,146 @@ smashing::load_dictionary (const std::string &filename)
       // report error - TODO could throw instead
       std::cout << "Failed to open " << filename << '\n';
     }
+}
+}
+
+template <>
+std::multimap<std::string, std::string>
+smashing::load_dictionary (const std::string &filename)
+{
+  std::multimap<std::string, std::string> dictionary;
+  // dictionary.insert({ key, value }); or
+  read_dictionary (filename, [&dictionary] (std::string key, std::string value) { dictionary.emplace (key, value); });
   return dictionary;
 }
 
+template <>
+smashing::FlatDictionary
+smashing::load_dictionary (const std::string &filename)
+{
+  try
+    {
+      return map_dictionary (filename);
+    }
+  catch (const std::runtime_error &)
+    {
+      // On purpose, as the multimap loader does: report it and give an empty dictionary.
+      // Call map_dictionary to have the exception instead.
+      std::cout << "Failed to open " << filename << '\n';
+      return {};
+    }
+}
+
+namespace
+{
+// What one thread makes of its share of a mapped file
+struct Share
+{
+  std::vector<char>                                 keys;
+  std::vector<smashing::FlatDictionary::value_type> entries; // sorted
+  std::vector<std::string_view>                     invalid;
+};
+
+// The mapping, and the keys views point into, kept alive by the dictionary
+struct MappedEntries
+{
+  smashing::MappedFile            file;
+  std::vector<std::vector<char> > keys;
+
+  explicit MappedEntries (const std::string &filename) : file (filename) {}
+};
+
+void
+split_lines (std::string_view text, Share &share)
+{
+  struct Pending
+  {
+    std::size_t      key;
+    std::size_t      length;
+    std::string_view definition;
+  };
+  std::vector<Pending> pending;
+  const char          *at  = text.data ();
+  const char          *end = text.data () + text.size ();
+  while (at < end)
+    {
+      const auto *newline  = static_cast<const char *> (std::memchr (at, '\n', static_cast<std::size_t> (end - at)));
+      const auto *line_end = newline ? newline : end;
+      const auto *comma
+          = static_cast<const char *> (std::memchr (at, ',', static_cast<std::size_t> (line_end - at)));
+      if (comma)
+        {
+          const auto key = share.keys.size ();
+          std::transform (at, comma, std::back_inserter (share.keys),
+                          [] (unsigned char c) { return static_cast<char> (std::tolower (c)); });
+          pending.push_back ({ key, static_cast<std::size_t> (comma - at),
+                               { comma + 1, static_cast<std::size_t> (line_end - comma - 1) } });
+        }
+      else
+        {
+          share.invalid.emplace_back (at, static_cast<std::size_t> (line_end - at));
+        }
+      at = newline ? newline + 1 : end;
+    }
+  // Only now has the arena stopped moving
+  share.entries.reserve (pending.size ());
+  for (const auto &line : pending)
+    {
+      share.entries.emplace_back (std::string_view (share.keys.data () + line.key, line.length), line.definition);
+    }
+  std::ranges::stable_sort (share.entries, {}, &smashing::FlatDictionary::value_type::first);
+}
+}
+
+smashing::FlatDictionary
+smashing::map_dictionary (const std::string &filename, unsigned threads, std::ostream &diagnostics)
+{
+  auto                   mapped = std::make_shared<MappedEntries> (filename);
+  const std::string_view text   = mapped->file.text ();
+
+  // A share of less than a megabyte is not worth a thread
+  constexpr std::size_t least_share = 1 << 20;
+  if (threads == 0)
+    {
+      threads = std::max (1u, std::thread::hardware_concurrency ());
+    }
+  threads = static_cast<unsigned> (std::min<std::size_t> (threads, text.size () / least_share + 1));
+
+  std::vector<std::size_t> cuts{ 0 };
+  for (unsigned i = 1; i < threads; ++i)
+    {
+      const auto newline = text.find ('\n', std::max (cuts.back (), text.size () / threads * i));
+      cuts.push_back (newline == std::string_view::npos ? text.size () : newline + 1);
+    }
+  cuts.push_back (text.size ());
+
+  std::vector<Share> shares (threads);
+  {
+    std::vector<std::jthread> workers;
+    for (unsigned i = 1; i < threads; ++i)
+      {
+        workers.emplace_back ([&, i] { split_lines (text.substr (cuts[i], cuts[i + 1] - cuts[i]), shares[i]); });
+      }
+    split_lines (text.substr (cuts[0], cuts[1] - cuts[0]), shares[0]);
+  }
+
+  // Each share is sorted; merging them in file order keeps equal keys in file order
+  std::vector<FlatDictionary::value_type> entries;
+  for (auto &share : shares)
+    {
+      const auto middle = static_cast<std::ptrdiff_t> (entries.size ());
+      entries.insert (entries.end (), share.entries.begin (), share.entries.end ());
+      std::inplace_merge (entries.begin (), entries.begin () + middle, entries.end (),
+                          [] (const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+      for (const auto line : share.invalid)
+        {
+          diagnostics << "***Invalid line\n" << line << "\nin " << filename << "***\n\n";
+        }
+      mapped->keys.push_back (std::move (share.keys));
+    }
+  return FlatDictionary::from_sorted (std::move (entries), std::move (mapped));
+}
+
 // Listing 7.8 Find an overlapping word more efficiently
 std::pair<std::string, int>
 smashing::find_overlapping_word (std::string word, const std::map<std::string, std::string> &dictionary)
@@ -66,6 +209,21 @@ smashing::find_overlapping_word (std::string word, const std::map<std::string, s
   return { "", -1 };
 }
 
+// Listing 7.8 with a trie: the first word, in order, starting with the longest suffix that starts any
+std::pair<std::string_view, int>
+smashing::find_overlapping_word (std::string_view word, const PrefixTrie &index)
+{
+  for (std::size_t offset = 1; offset < word.size (); ++offset)
+    {
+      auto [lb, ub] = index.prefix_range (word.substr (offset));
+      if (lb != ub)
+        {
+          return { lb->first, static_cast<int> (offset) };
+        }
+    }
+  return { "", -1 };
+}
+
 // Could use
 // #include <format>
 // #include <string_view>
@@ -104,16 +262,30 @@ smashing::simple_answer_smash (const std::map<std::string, std::string> &keyword
     }
 }
 
-// Listing 7.14 Better answer smash game
+namespace
+{
+// Listing 7.14 Better answer smash game, for either kind of dictionary
+template <typename Keywords, typename Dictionary>
 void
-smashing::answer_smash (const std::multimap<std::string, std::string> &keywords,
-                        const std::multimap<std::string, std::string> &dictionary)
+play_answer_smash (const Keywords &keywords, const Dictionary &dictionary)
 {
+  using namespace smashing;
   std::mt19937 gen{ std::random_device{}() };
-  auto         select_one = [&gen] (auto lb, auto ub, auto dest) { std::sample (lb, ub, dest, 1, gen); };
+  auto         select_one = [&gen] (auto lb, auto ub, auto dest) { select_uniformly (lb, ub, dest, gen); };
   const int    count      = 5;
-  std::vector<std::pair<std::string, std::string> > first_words;
-  std::ranges::sample (keywords, std::back_inserter (first_words), count, gen);
+  std::vector<std::pair<typename Keywords::value_type::first_type, typename Keywords::value_type::second_type> >
+      first_words;
+  if constexpr (std::ranges::random_access_range<const Keywords>)
+    {
+      for (const auto i : sample_indices (std::ranges::size (keywords), count, gen))
+        {
+          first_words.emplace_back (std::ranges::begin (keywords)[static_cast<std::ptrdiff_t> (i)]);
+        }
+    }
+  else
+    {
+      std::ranges::sample (keywords, std::back_inserter (first_words), count, gen);
+    }
   for (const auto &[word, definition] : first_words)
     {
       auto [second_word, second_definition, offset]
@@ -123,7 +295,8 @@ smashing::answer_smash (const std::multimap<std::string, std::string> &keywords,
           continue;
         }
       std::cout << definition << "\nAND\n" << second_definition << '\n';
-      std::string answer = word.substr (0, offset) + second_word;
+      std::string answer{ word.substr (0, offset) };
+      answer += second_word;
       std::string response;
       std::getline (std::cin, response);
       if (str_tolower (response) == answer)
@@ -137,3 +310,23 @@ smashing::answer_smash (const std::multimap<std::string, std::string> &keywords,
       std::cout << word << ' ' << second_word << "\n\n\n";
     }
 }
+}
+
+void
+smashing::answer_smash (const std::multimap<std::string, std::string> &keywords,
+                        const std::multimap<std::string, std::string> &dictionary)
+{
+  play_answer_smash (keywords, dictionary);
+}
+
+void
+smashing::answer_smash (const FlatDictionary &keywords, const FlatDictionary &dictionary)
+{
+  play_answer_smash (keywords, PrefixTrie (dictionary));
+}
+
+void
+smashing::answer_smash (const SnapshotDictionary &keywords, const SnapshotDictionary &dictionary)
+{
+  play_answer_smash (keywords, dictionary);
+}
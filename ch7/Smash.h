@@ -1,9 +1,20 @@
 #pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
 #include <map>
+#include <random>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <unordered_set>
 #include <vector>
 
+#include "FlatDictionary.h"
+#include "PrefixTrie.h"
+#include "Snapshot.h"
+
 namespace smashing
 {
 // Listing 7.11 Select a word from a multimap
@@ -33,12 +44,88 @@ select_overlapping_word_from_dictionary (std::string word, const std::multimap<s
   return { "", "", -1 };
 }
 
+// Anything that finds the words starting with a prefix itself: a FlatDictionary, a PrefixTrie or a snapshot.
+// A concept rather than a type, so a braced list still means a multimap.
+template <typename D>
+concept PrefixSearchable = requires (const D &dictionary, std::string_view prefix) {
+  dictionary.prefix_range (prefix);
+};
+
+// Listing 7.11 for a PrefixSearchable dictionary: every stem is a view into word, so nothing is allocated at any
+// offset, and what comes back views the dictionary
+template <PrefixSearchable Dictionary, typename T>
+std::tuple<std::string_view, std::string_view, int>
+select_overlapping_word_from_dictionary (std::string_view word, const Dictionary &dictionary, T select_function)
+{
+  for (std::size_t offset = 1; offset < word.size (); ++offset)
+    {
+      auto [lb, ub] = dictionary.prefix_range (word.substr (offset));
+      if (lb != ub)
+        {
+          std::pair<std::string_view, std::string_view> chosen;
+          select_function (lb, ub, &chosen);
+          return { chosen.first, chosen.second, static_cast<int> (offset) };
+        }
+    }
+  return { "", "", -1 };
+}
+
+// Listing 7.14's select_one, in constant time when the words are random access: one draw picks the rank,
+// where std::sample walks the whole range
+template <std::input_iterator I, typename Out, std::uniform_random_bit_generator G>
+void
+select_uniformly (I lb, I ub, Out dest, G &gen)
+{
+  if constexpr (std::random_access_iterator<I>)
+    {
+      std::uniform_int_distribution<std::iter_difference_t<I> > rank (0, ub - lb - 1);
+      *dest = lb[rank (gen)];
+    }
+  else
+    {
+      std::sample (lb, ub, dest, 1, gen);
+    }
+}
+
+// count different indices below population (all of them if there are fewer), in order, equally likely.
+// Floyd's algorithm: one draw per index chosen, whatever the population.
+template <std::uniform_random_bit_generator G>
+std::vector<std::size_t>
+sample_indices (std::size_t population, std::size_t count, G &gen)
+{
+  count = std::min (count, population);
+  std::unordered_set<std::size_t> chosen;
+  for (std::size_t j = population - count; j < population; ++j)
+    {
+      const std::size_t t = std::uniform_int_distribution<std::size_t> (0, j) (gen);
+      chosen.insert (chosen.contains (t) ? j : t);
+    }
+  std::vector<std::size_t> indices (chosen.begin (), chosen.end ());
+  std::ranges::sort (indices);
+  return indices;
+}
+
 std::pair<std::string, int> find_overlapping_word (std::string                               word,
                                                    const std::map<std::string, std::string> &dictionary);
 void                        simple_answer_smash (const std::map<std::string, std::string> &keywords,
                                                  const std::map<std::string, std::string> &dictionary);
 
-std::multimap<std::string, std::string> load_dictionary (const std::string &filename);
-void                                    answer_smash (const std::multimap<std::string, std::string> &keywords,
-                                                      const std::multimap<std::string, std::string> &dictionary);
+std::pair<std::string_view, int> find_overlapping_word (std::string_view word, const PrefixTrie &index);
+
+// A std::multimap by default; load_dictionary<FlatDictionary> for a flat one
+template <typename Dictionary = std::multimap<std::string, std::string> >
+Dictionary load_dictionary (const std::string &filename);
+template <> std::multimap<std::string, std::string> load_dictionary (const std::string &filename);
+template <> FlatDictionary                          load_dictionary (const std::string &filename);
+
+// Maps the file and splits it with memchr: definitions stay views into the mapping and lowercased keys go into
+// one arena per thread. threads == 0 uses one per core; each takes a share of the file, cut at line ends.
+// Lines without a comma are reported to diagnostics. Throws std::runtime_error if the file cannot be mapped.
+FlatDictionary map_dictionary (const std::string &filename, unsigned threads = 1,
+                               std::ostream &diagnostics = std::cout);
+
+void answer_smash (const std::multimap<std::string, std::string> &keywords,
+                   const std::multimap<std::string, std::string> &dictionary);
+void answer_smash (const FlatDictionary &keywords, const FlatDictionary &dictionary);
+void answer_smash (const SnapshotDictionary &keywords, const SnapshotDictionary &dictionary);
 }
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "Snapshot.h"
+
+// The file is, all little endian:
+//   "SMASHSNP", u32 version, u32 zero, u64 file size, u64 offset of the keywords, u64 offset of the dictionary
+// then each table, starting on an 8 byte boundary:
+//   u64 entries, u64 trie nodes, u64 bytes of keys, u64 bytes of definitions
+//   u64 key starts[entries + 1], u64 definition starts[entries + 1], trie nodes[trie nodes]
+//   keys, definitions, trie labels[trie nodes]
+namespace
+{
+constexpr char        magic[8]           = { 'S', 'M', 'A', 'S', 'H', 'S', 'N', 'P' };
+constexpr std::size_t header_bytes       = 40;
+constexpr std::size_t table_header_bytes = 32;
+
+static_assert (std::endian::native == std::endian::little, "Snapshots are mapped as they are, little endian");
+static_assert (sizeof (smashing::PrefixTrie::Node) == 16 && std::is_trivially_copyable_v<smashing::PrefixTrie::Node>);
+
+// Keeps count of where it is, to line tables up on 8 bytes
+struct Writer
+{
+  std::ofstream out;
+  std::uint64_t at = 0;
+
+  void
+  bytes (const void *data, std::size_t size)
+  {
+    out.write (static_cast<const char *> (data), static_cast<std::streamsize> (size));
+    at += size;
+  }
+  template <typename T>
+  void
+  value (const T &item)
+  {
+    bytes (&item, sizeof item);
+  }
+  template <typename T>
+  void
+  values (std::span<const T> items)
+  {
+    bytes (items.data (), items.size_bytes ());
+  }
+  void
+  align ()
+  {
+    const char zeros[8]{};
+    bytes (zeros, (8 - at % 8) % 8);
+  }
+};
+
+std::uint64_t
+write_table (Writer &writer, const smashing::FlatDictionary &dictionary)
+{
+  const smashing::PrefixTrie trie (dictionary);
+  std::vector<std::uint64_t> key_starts{ 0 };
+  std::vector<std::uint64_t> definition_starts{ 0 };
+  for (const auto &[key, definition] : dictionary)
+    {
+      key_starts.push_back (key_starts.back () + key.size ());
+      definition_starts.push_back (definition_starts.back () + definition.size ());
+    }
+
+  writer.align ();
+  const std::uint64_t offset = writer.at;
+  writer.value (std::uint64_t{ dictionary.size () });
+  writer.value (std::uint64_t{ trie.node_count () });
+  writer.value (key_starts.back ());
+  writer.value (definition_starts.back ());
+  writer.values (std::span<const std::uint64_t> (key_starts));
+  writer.values (std::span<const std::uint64_t> (definition_starts));
+  writer.values (trie.node_array ());
+  for (const auto &[key, definition] : dictionary)
+    {
+      writer.bytes (key.data (), key.size ());
+    }
+  for (const auto &[key, definition] : dictionary)
+    {
+      writer.bytes (definition.data (), definition.size ());
+    }
+  writer.values (trie.label_array ());
+  return offset;
+}
+
+std::uint64_t
+read_u64 (const char *at)
+{
+  std::uint64_t value;
+  std::memcpy (&value, at, sizeof value);
+  return value;
+}
+
+[[noreturn]] void
+not_a_snapshot (const std::string &filename)
+{
+  throw std::runtime_error ("Not a snapshot: " + filename);
+}
+}
+
+void
+smashing::write_snapshot (const std::string &filename, const FlatDictionary &keywords,
+                          const FlatDictionary &dictionary)
+{
+  // Written to the side and renamed, so a reader never maps half a snapshot
+  const std::string partial = filename + ".partial";
+  {
+    Writer writer{ std::ofstream (partial, std::ios::binary | std::ios::trunc) };
+    if (!writer.out)
+      {
+        throw std::runtime_error ("Failed to open " + partial);
+      }
+    const char header[header_bytes]{};
+    writer.bytes (header, sizeof header);
+    const std::uint64_t keyword_offset    = write_table (writer, keywords);
+    const std::uint64_t dictionary_offset = write_table (writer, dictionary);
+    const std::uint64_t size              = writer.at;
+
+    writer.out.seekp (0);
+    writer.bytes (magic, sizeof magic);
+    writer.value (Snapshot::version);
+    writer.value (std::uint32_t{ 0 });
+    writer.value (size);
+    writer.value (keyword_offset);
+    writer.value (dictionary_offset);
+    writer.out.close ();
+    if (!writer.out)
+      {
+        throw std::runtime_error ("Failed to write " + partial);
+      }
+  }
+  std::filesystem::rename (partial, filename);
+}
+
+smashing::Snapshot::Snapshot (const std::string &filename) : file (filename)
+{
+  const auto text = file.text ();
+  if (text.size () < header_bytes || !std::equal (std::begin (magic), std::end (magic), text.data ()))
+    {
+      not_a_snapshot (filename);
+    }
+  std::uint32_t found_version;
+  std::memcpy (&found_version, text.data () + 8, sizeof found_version);
+  if (found_version != version)
+    {
+      throw std::runtime_error ("Snapshot " + filename + " is version " + std::to_string (found_version)
+                                + ", not " + std::to_string (version));
+    }
+  if (read_u64 (text.data () + 16) != text.size ())
+    {
+      not_a_snapshot (filename);
+    }
+  keyword_table    = table (read_u64 (text.data () + 24), filename);
+  dictionary_table = table (read_u64 (text.data () + 32), filename);
+}
+
+smashing::SnapshotDictionary
+smashing::Snapshot::table (std::uint64_t offset, const std::string &filename) const
+{
+  const auto text = file.text ();
+  if (offset % 8 != 0 || offset < header_bytes || offset > text.size ()
+      || text.size () - offset < table_header_bytes)
+    {
+      not_a_snapshot (filename);
+    }
+  const char         *at          = text.data () + offset;
+  const std::uint64_t entries     = read_u64 (at);
+  const std::uint64_t nodes       = read_u64 (at + 8);
+  const std::uint64_t key_bytes   = read_u64 (at + 16);
+  const std::uint64_t definitions = read_u64 (at + 24);
+  // Each size is checked against what is left before any sum of them could overflow
+  const std::uint64_t room = text.size () - offset - table_header_bytes;
+  if (entries >= room / 16 || nodes == 0 || nodes > room / 17 || key_bytes > room || definitions > room
+      || 16 * (entries + 1) + 17 * nodes + key_bytes + definitions > room)
+    {
+      not_a_snapshot (filename);
+    }
+
+  SnapshotDictionary loaded;
+  at += table_header_bytes;
+  loaded.key_starts = { reinterpret_cast<const std::uint64_t *> (at), entries + 1 };
+  at += 8 * (entries + 1);
+  loaded.definition_starts = { reinterpret_cast<const std::uint64_t *> (at), entries + 1 };
+  at += 8 * (entries + 1);
+  loaded.nodes = { reinterpret_cast<const PrefixTrie::Node *> (at), nodes };
+  at += 16 * nodes;
+  loaded.keys = at;
+  at += key_bytes;
+  loaded.definitions = at;
+  at += definitions;
+  loaded.labels = { at, nodes };
+  if (loaded.key_starts.front () != 0 || loaded.key_starts.back () != key_bytes
+      || loaded.definition_starts.front () != 0 || loaded.definition_starts.back () != definitions
+      || loaded.nodes.front ().count != entries)
+    {
+      not_a_snapshot (filename);
+    }
+  return loaded;
+}
+
+std::pair<smashing::SnapshotDictionary::const_iterator, smashing::SnapshotDictionary::const_iterator>
+smashing::SnapshotDictionary::prefix_range (std::string_view prefix) const
+{
+  const auto node = PrefixTrie::find (nodes, labels, prefix);
+  if (node == PrefixTrie::no_node)
+    {
+      return { end (), end () };
+    }
+  const auto first = begin () + nodes[node].first;
+  return { first, first + nodes[node].count };
+}
@@ -0,0 +1,191 @@
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "FlatDictionary.h"
+#include "MappedFile.h"
+#include "PrefixTrie.h"
+
+namespace smashing
+{
+// A dictionary read straight out of a mapped snapshot: offset tables into blobs of keys and definitions,
+// sorted by key, and a PrefixTrie's arrays as they were built. Nothing is parsed, copied or sorted to use it.
+class SnapshotDictionary
+{
+  std::span<const std::uint64_t>    key_starts; // key i is keys[key_starts[i]] up to keys[key_starts[i + 1]]
+  std::span<const std::uint64_t>    definition_starts;
+  const char                       *keys        = nullptr;
+  const char                       *definitions = nullptr;
+  std::span<const PrefixTrie::Node> nodes;
+  std::span<const char>             labels;
+
+  friend class Snapshot;
+
+public:
+  using value_type = std::pair<std::string_view, std::string_view>;
+
+  // Makes each entry as it is read, so hands out values rather than references, as vector<bool> does
+  class const_iterator
+  {
+    const SnapshotDictionary *dictionary = nullptr;
+    std::ptrdiff_t            index      = 0;
+
+  public:
+    using iterator_concept  = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = SnapshotDictionary::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = value_type;
+    using pointer           = void;
+
+    const_iterator () = default;
+    const_iterator (const SnapshotDictionary *dictionary, std::ptrdiff_t index) : dictionary (dictionary), index (index)
+    {
+    }
+
+    value_type
+    operator* () const
+    {
+      return (*dictionary)[static_cast<std::size_t> (index)];
+    }
+    value_type
+    operator[] (difference_type n) const
+    {
+      return (*dictionary)[static_cast<std::size_t> (index + n)];
+    }
+    const_iterator &
+    operator++ ()
+    {
+      ++index;
+      return *this;
+    }
+    const_iterator
+    operator++ (int)
+    {
+      return { dictionary, index++ };
+    }
+    const_iterator &
+    operator-- ()
+    {
+      --index;
+      return *this;
+    }
+    const_iterator
+    operator-- (int)
+    {
+      return { dictionary, index-- };
+    }
+    const_iterator &
+    operator+= (difference_type n)
+    {
+      index += n;
+      return *this;
+    }
+    const_iterator &
+    operator-= (difference_type n)
+    {
+      index -= n;
+      return *this;
+    }
+    friend const_iterator
+    operator+ (const_iterator it, difference_type n)
+    {
+      return it += n;
+    }
+    friend const_iterator
+    operator+ (difference_type n, const_iterator it)
+    {
+      return it += n;
+    }
+    friend const_iterator
+    operator- (const_iterator it, difference_type n)
+    {
+      return it -= n;
+    }
+    friend difference_type
+    operator- (const const_iterator &lhs, const const_iterator &rhs)
+    {
+      return lhs.index - rhs.index;
+    }
+    friend bool
+    operator== (const const_iterator &lhs, const const_iterator &rhs)
+    {
+      return lhs.index == rhs.index;
+    }
+    friend std::strong_ordering
+    operator<=> (const const_iterator &lhs, const const_iterator &rhs)
+    {
+      return lhs.index <=> rhs.index;
+    }
+  };
+
+  std::size_t
+  size () const
+  {
+    return key_starts.empty () ? 0 : key_starts.size () - 1;
+  }
+  bool
+  empty () const
+  {
+    return size () == 0;
+  }
+  const_iterator
+  begin () const
+  {
+    return { this, 0 };
+  }
+  const_iterator
+  end () const
+  {
+    return { this, static_cast<std::ptrdiff_t> (size ()) };
+  }
+  value_type
+  operator[] (std::size_t i) const
+  {
+    return { { keys + key_starts[i], key_starts[i + 1] - key_starts[i] },
+             { definitions + definition_starts[i], definition_starts[i + 1] - definition_starts[i] } };
+  }
+
+  // Every word starting with prefix, through the stored trie
+  std::pair<const_iterator, const_iterator> prefix_range (std::string_view prefix) const;
+};
+
+// The keywords and the dictionary for answer smash, compiled by write_snapshot.
+// Opening one maps the file and checks the header and the sizes of each table; nothing else is read
+// until it is used. The contents are trusted as write_snapshot left them.
+class Snapshot
+{
+  MappedFile         file;
+  SnapshotDictionary keyword_table;
+  SnapshotDictionary dictionary_table;
+
+  SnapshotDictionary table (std::uint64_t offset, const std::string &filename) const;
+
+public:
+  static constexpr std::uint32_t version = 1;
+
+  // Throws std::runtime_error if the file cannot be mapped or is not a snapshot of this version
+  explicit Snapshot (const std::string &filename);
+
+  const SnapshotDictionary &
+  keywords () const
+  {
+    return keyword_table;
+  }
+  const SnapshotDictionary &
+  dictionary () const
+  {
+    return dictionary_table;
+  }
+};
+
+// Each dictionary goes in as FlatDictionary keeps it, lowercased and sorted, with a PrefixTrie built over it.
+// Throws std::runtime_error if the file cannot be written.
+void write_snapshot (const std::string &filename, const FlatDictionary &keywords, const FlatDictionary &dictionary);
+}
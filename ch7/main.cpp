@@ -1,9 +1,15 @@
 #include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
 
+#include "OverlapTable.h"
+#include "PuzzleBank.h"
 #include "Smash.h"
 
 // Listing 7.5 Find an overlapping word
@@ -95,6 +101,269 @@ check_properties ()
       word, { { "a", "1" }, { "aaaa", "1" }, { "aaab", "1" }, { "aaabb", "2" }, { "aaabc", "2" }, { "aabbc", "3" } },
       select_last);
   assert (g2b == "aabbc");
+
+  // A flat dictionary finds the same words, with every stem a view rather than a new string
+  const FlatDictionary first_flat (first_2);
+  const FlatDictionary second_flat (second_2);
+  auto [flat1, flat_definition1, flat_offset1]
+      = select_overlapping_word_from_dictionary ("sprint", second_flat, select_first);
+  assert (flat1 == "integer");
+  auto [flat2, flat_definition2, flat_offset2]
+      = select_overlapping_word_from_dictionary ("minus", second_flat, select_first);
+  assert (flat2 == "struct");
+  auto [flat3, flat_definition3, flat_offset3]
+      = select_overlapping_word_from_dictionary ("vector", first_flat, select_first);
+  assert (flat3 == "torch");
+  auto [flat4, flat_definition4, flat_offset4]
+      = select_overlapping_word_from_dictionary ("class", first_flat, select_first);
+  assert (flat4 == "assault");
+  assert (flat_offset4 == 2);
+  const FlatDictionary no_words;
+  auto [flat_none, flat_no_definition, flat_no_offset]
+      = select_overlapping_word_from_dictionary ("class", no_words, select_first);
+  assert (flat_none == "");
+  assert (flat_no_offset == -1);
+
+  const FlatDictionary prefixed{ { "aabc", "2" }, { "a", "1" },    { "aaa", "1" },
+                                 { "aab", "1" },  { "abbc", "3" }, { "aabb", "2" } };
+  auto [g1f, d1f, o1f] = select_overlapping_word_from_dictionary (word, prefixed, select_first);
+  assert (g1f == "aaa");
+  auto [g1fb, d1fb, o1fb] = select_overlapping_word_from_dictionary (word, prefixed, select_last);
+  assert (g1fb == "aabc" && d1fb == "2");
+  auto [aab_first, aab_last] = prefixed.prefix_range ("aab");
+  assert (aab_last - aab_first == 3 && aab_first->first == "aab");
+  assert (prefixed.lower_bound (std::string ("aab")) == aab_first);
+  assert (prefixed.equal_range ("aabb").second - prefixed.equal_range ("aabb").first == 1);
+  assert (prefixed.prefix_range ("b").first == prefixed.prefix_range ("b").second);
+  assert (prefixed.prefix_range ("").second - prefixed.prefix_range ("").first == 6);
+
+  // A trie over the same words finds the same words, and the same runs of them, as a binary search
+  const PrefixTrie second_trie (second_flat);
+  auto [trie1, trie_offset1] = find_overlapping_word ("sprint", second_trie);
+  assert (trie1 == "integer");
+  auto [trie2, trie_offset2] = find_overlapping_word ("minus", second_trie);
+  assert (trie2 == "struct");
+  auto [trie3, trie_offset3] = find_overlapping_word ("class", PrefixTrie (first_flat));
+  assert (trie3 == "assault" && trie_offset3 == 2);
+  auto [trie_none, trie_no_offset] = find_overlapping_word ("class", PrefixTrie (no_words));
+  assert (trie_none == "" && trie_no_offset == -1);
+
+  const PrefixTrie prefixed_trie (prefixed);
+  auto [g1t, d1t, o1t] = select_overlapping_word_from_dictionary (word, prefixed_trie, select_first);
+  assert (g1t == "aaa");
+  auto [g1tb, d1tb, o1tb] = select_overlapping_word_from_dictionary (word, prefixed_trie, select_last);
+  assert (g1tb == "aabc" && d1tb == "2");
+  for (std::string_view prefix : { "", "a", "aa", "aab", "aabb", "aabbc", "ab", "b", "abc" })
+    {
+      const auto [lb, ub] = prefixed.prefix_range (prefix);
+      assert (prefixed_trie.count (prefix) == static_cast<std::size_t> (ub - lb));
+      assert (lb == ub || prefixed_trie.prefix_range (prefix) == std::pair (lb, ub));
+      for (std::size_t rank = 0; rank < prefixed_trie.count (prefix); ++rank)
+        {
+          assert (prefixed_trie.nth (prefix, rank)->first.starts_with (prefix));
+        }
+      assert (prefixed_trie.nth (prefix, prefixed_trie.count (prefix)) == prefixed.end ());
+    }
+
+  // All the overlaps at once: each offset where a suffix starts some words, with the run of words it starts
+  const FlatDictionary class_only{ { "class", "" } };
+  const FlatDictionary endings{ { "assault", "" }, { "ss", "" }, { "sss", "" }, { "s", "" }, { "lass", "" } };
+  const OverlapTable   class_overlaps (class_only, endings);
+  assert (class_overlaps.keywords () == 1 && class_overlaps[0].size () == 4 && class_overlaps.puzzles () == 7);
+  for (std::uint32_t i = 0; i < 4; ++i)
+    {
+      const auto &overlap = class_overlaps[0][i];
+      const auto [lb, ub] = endings.prefix_range (std::string_view ("class").substr (i + 1));
+      assert (overlap.offset == i + 1 && endings.begin () + overlap.first == lb && overlap.count == ub - lb);
+    }
+
+  // Random picks: any rank in a random access range is equally likely, as is any set of keywords
+  {
+    std::mt19937     gen (7);
+    std::vector<int> picks (6);
+    const auto [lb, ub] = prefixed.prefix_range ("aa");
+    for (int i = 0; i < 6'000; ++i)
+      {
+        FlatDictionary::value_type picked;
+        select_uniformly (lb, ub, &picked, gen);
+        ++picks[static_cast<std::size_t> (std::ranges::find (prefixed, picked) - prefixed.begin ())];
+      }
+    assert (picks.front () == 0 && picks.back () == 0);
+    assert (std::all_of (picks.begin () + 1, picks.end () - 1, [] (int n) { return n > 1'300 && n < 1'700; }));
+
+    std::vector<int> chosen (10);
+    for (int i = 0; i < 10'000; ++i)
+      {
+        const auto indices = sample_indices (10, 3, gen);
+        assert (indices.size () == 3 && std::ranges::is_sorted (indices)
+                && std::ranges::adjacent_find (indices) == indices.end ());
+        for (const auto index : indices)
+          {
+            ++chosen[index];
+          }
+      }
+    assert (std::ranges::all_of (chosen, [] (int n) { return n > 2'800 && n < 3'200; }));
+    assert (sample_indices (2, 5, gen) == std::vector<std::size_t> ({ 0, 1 }) && sample_indices (0, 5, gen).empty ());
+  }
+
+  // Loading either way gives the same entries, in the same order
+  const auto multimap = load_dictionary ("keywords.csv");
+  const auto flat     = load_dictionary<FlatDictionary> ("keywords.csv");
+  assert (std::ranges::equal (multimap, flat, [] (const auto &lhs, const auto &rhs) {
+    return lhs.first == rhs.first && lhs.second == rhs.second;
+  }));
+
+  // Mapped and split across threads, a file gives the entries, in the order, of reading it line by line
+  {
+    const auto    path = std::filesystem::temp_directory_path () / "smash_map_test.csv";
+    std::ofstream out (path);
+    for (int i = 0; i < 60'000; ++i)
+      {
+        out << "Word" << (i * 7919) % 1000 << ",definition " << i << std::string (60, '.') << '\n';
+      }
+    out << "LAST,no newline";
+    out.close ();
+    const auto by_line   = load_dictionary (path.string ());
+    const auto by_thread = map_dictionary (path.string (), 4);
+    assert (by_thread.size () == 60'001 && by_thread.prefix_range ("last").first->second == "no newline");
+    assert (std::ranges::equal (by_line, by_thread, [] (const auto &lhs, const auto &rhs) {
+      return lhs.first == rhs.first && lhs.second == rhs.second;
+    }));
+    std::filesystem::remove (path);
+
+    // and says which lines it could not read where it is told to
+    out.open (path);
+    out << "word,definition\nno comma\n";
+    out.close ();
+    std::ostringstream diagnostics;
+    assert (map_dictionary (path.string (), 1, diagnostics).size () == 1);
+    assert (diagnostics.str ().find ("***Invalid line\nno comma\n") != std::string::npos);
+    std::filesystem::remove (path);
+  }
+
+  // A snapshot maps back to the same entries, finding the same words through its stored trie
+  {
+    const auto path = (std::filesystem::temp_directory_path () / "smash_test.snapshot").string ();
+    write_snapshot (path, prefixed, second_flat);
+    const Snapshot snapshot (path);
+    const auto    &prefixes = snapshot.keywords ();
+    assert (std::ranges::equal (prefixes, prefixed) && std::ranges::equal (snapshot.dictionary (), second_flat));
+    for (std::string_view prefix : { "", "a", "aa", "aab", "aabb", "aabbc", "ab", "b", "abc" })
+      {
+        const auto [lb, ub]     = prefixed.prefix_range (prefix);
+        const auto [slb, sub]   = prefixes.prefix_range (prefix);
+        assert (sub - slb == ub - lb && (lb == ub || slb - prefixes.begin () == lb - prefixed.begin ()));
+      }
+    auto [g1s, d1s, o1s] = select_overlapping_word_from_dictionary (word, prefixes, select_last);
+    assert (g1s == "aabc" && d1s == "2");
+    auto [s1, sd1, so1] = select_overlapping_word_from_dictionary ("sprint", snapshot.dictionary (), select_first);
+    assert (s1 == "integer" && so1 == 3);
+
+    // Anything else is refused, rather than read
+    std::filesystem::resize_file (path, std::filesystem::file_size (path) - 1);
+    bool refused = false;
+    try
+      {
+        const Snapshot truncated (path);
+      }
+    catch (const std::runtime_error &)
+      {
+        refused = true;
+      }
+    assert (refused);
+    std::filesystem::remove (path);
+  }
+
+  // Every suffix of every keyword finds the same words in the trie as by binary search
+  const auto       words = load_dictionary<FlatDictionary> ("dictionary.csv");
+  const PrefixTrie index (words);
+  for (const auto &[keyword, definition] : flat)
+    {
+      for (std::size_t offset = 1; offset < keyword.size (); ++offset)
+        {
+          const auto [lb, ub] = words.prefix_range (keyword.substr (offset));
+          assert (index.count (keyword.substr (offset)) == static_cast<std::size_t> (ub - lb));
+          assert (lb == ub || index.prefix_range (keyword.substr (offset)).first == lb);
+        }
+    }
+  // and the overlap table holds the same runs
+  const OverlapTable table (flat, words);
+  for (std::size_t k = 0; k < flat.size (); ++k)
+    {
+      const std::string_view keyword = flat.begin ()[static_cast<std::ptrdiff_t> (k)].first;
+      auto                   overlap = table[k].begin ();
+      for (std::size_t offset = 1; offset < keyword.size (); ++offset)
+        {
+          const auto [lb, ub] = words.prefix_range (keyword.substr (offset));
+          if (lb != ub)
+            {
+              assert (overlap != table[k].end () && overlap->offset == offset);
+              assert (words.begin () + overlap->first == lb && overlap->count == ub - lb);
+              ++overlap;
+            }
+        }
+      assert (overlap == table[k].end ());
+    }
+
+  // A puzzle bank holds each of those puzzles, written the same way whatever the threads
+  std::ostringstream one_thread;
+  std::ostringstream three_threads;
+  assert (write_puzzle_bank (one_thread, flat, words, { .threads = 1 }) == table.puzzles ());
+  assert (write_puzzle_bank (three_threads, flat, words, { .threads = 3 }) == table.puzzles ());
+  assert (one_thread.str () == three_threads.str ());
+  assert (static_cast<std::size_t> (std::ranges::count (one_thread.str (), '\n')) == table.puzzles ());
+  {
+    // A stream that throws stops the workers too, rather than leaving them waiting for room
+    struct Refusing : std::streambuf
+    {
+      int_type
+      overflow (int_type) override
+      {
+        return traits_type::eof ();
+      }
+    };
+    Refusing     refusing;
+    std::ostream nowhere (&refusing);
+    nowhere.exceptions (std::ios::badbit);
+    bool thrown = false;
+    try
+      {
+        write_puzzle_bank (nowhere, words, words, { .threads = 1 });
+      }
+    catch (const std::ios::failure &)
+      {
+        thrown = true;
+      }
+    assert (thrown);
+  }
+  {
+    const FlatDictionary repeats{ { "aaa", "say \"a\"" } };
+    const FlatDictionary tails{ { "aab", "1" }, { "ab", "2" } };
+    std::ostringstream   jsonl;
+    assert (write_puzzle_bank (jsonl, repeats, tails) == 3);
+    assert (jsonl.str ().starts_with (R"({"first_word":"aaa","second_word":"aab","offset":1,"answer":"aaab",)"
+                                      R"("first_definition":"say \"a\"","second_definition":"1"})"
+                                      "\n"));
+
+    // aaa + aab at offset 2 makes aaab again
+    std::stringstream binary;
+    assert (write_puzzle_bank (binary, repeats, tails, { .format = PuzzleFormat::binary, .deduplicate = true }) == 2);
+    const std::vector<Puzzle> expected{ { "aaa", "aab", 1, "aaab", "say \"a\"", "1" },
+                                        { "aaa", "aab", 2, "aaaab", "say \"a\"", "1" } };
+    assert (read_puzzle_bank (binary) == expected);
+
+    std::istringstream truncated (binary.str ().substr (0, binary.str ().size () - 1));
+    bool               refused = false;
+    try
+      {
+        read_puzzle_bank (truncated);
+      }
+    catch (const std::runtime_error &)
+      {
+        refused = true;
+      }
+    assert (refused);
+  }
 }
 
 // Listing 7.1 Creating and displaying a map, along with some one liners considered in the text
@@ -138,13 +407,51 @@ structure_bindings ()
 }
 
 // Listing 7.15, Proper answer smash game but shown directly in main in the text
+// load_dictionary without <FlatDictionary> plays with multimaps, as in the text.
+// The CSVs are compiled into a snapshot the first time, and again whenever either changes or the snapshot
+// will not open; otherwise the game maps the snapshot and starts without parsing anything.
 void
 full_game ()
 {
   using namespace smashing;
-  const auto dictionary = load_dictionary (R"(dictionary.csv)");
-  const auto keywords   = load_dictionary (R"(keywords.csv)");
-  answer_smash (keywords, dictionary);
+  namespace fs             = std::filesystem;
+  const std::string stored = "smash.snapshot";
+
+  auto compile = [&stored] {
+    write_snapshot (stored, load_dictionary<FlatDictionary> (R"(keywords.csv)"),
+                    load_dictionary<FlatDictionary> (R"(dictionary.csv)"));
+  };
+  std::error_code                 error;
+  const auto                      compiled = fs::last_write_time (stored, error);
+  std::unique_ptr<const Snapshot> snapshot;
+  try
+    {
+      if (error || compiled < fs::last_write_time ("dictionary.csv", error)
+          || compiled < fs::last_write_time ("keywords.csv", error))
+        {
+          compile ();
+        }
+      try
+        {
+          snapshot = std::make_unique<const Snapshot> (stored);
+        }
+      catch (const std::runtime_error &e)
+        {
+          // From another version, or damaged
+          std::cout << e.what () << ", so compiling it again\n";
+          compile ();
+          snapshot = std::make_unique<const Snapshot> (stored);
+        }
+    }
+  catch (const std::exception &e)
+    {
+      std::cout << e.what () << ", so playing from the CSVs\n";
+      const auto dictionary = load_dictionary<FlatDictionary> (R"(dictionary.csv)");
+      const auto keywords   = load_dictionary<FlatDictionary> (R"(keywords.csv)");
+      answer_smash (keywords, dictionary);
+      return;
+    }
+  answer_smash (snapshot->keywords (), snapshot->dictionary ());
 }
 
 // Listing 7.7 Play the first version of answer smash
@@ -170,9 +477,76 @@ hard_coded_game ()
   smashing::simple_answer_smash (keywords, dictionary);
 }
 
+// Not a game: every puzzle the CSVs make, for a bank of puzzles made up front.
+// ch7 --puzzles [--binary] [--unique] [--threads n] [file], to standard output without a file
 int
-main ()
+puzzle_bank (const std::vector<std::string_view> &args)
 {
+  using namespace smashing;
+  // Before any I/O, so std::cout buffers the bank too
+  std::ios::sync_with_stdio (false);
+  try
+    {
+      PuzzleBankOptions options;
+      std::string       filename;
+      for (std::size_t i = 0; i < args.size (); ++i)
+        {
+          if (args[i] == "--binary")
+            {
+              options.format = PuzzleFormat::binary;
+            }
+          else if (args[i] == "--unique")
+            {
+              options.deduplicate = true;
+            }
+          else if (args[i] == "--threads" && i + 1 < args.size ())
+            {
+              options.threads = static_cast<unsigned> (std::stoul (std::string (args[++i])));
+            }
+          else if (!args[i].starts_with ("--") && filename.empty ())
+            {
+              filename = args[i];
+            }
+          else
+            {
+              std::cerr << "Usage: ch7 --puzzles [--binary] [--unique] [--threads n] [file]\n";
+              return 2;
+            }
+        }
+
+      // The bank may be going to std::cout, so anything else goes to std::cerr
+      const auto    keywords   = map_dictionary ("keywords.csv", options.threads, std::cerr);
+      const auto    dictionary = map_dictionary ("dictionary.csv", options.threads, std::cerr);
+      std::ofstream file;
+      if (!filename.empty ())
+        {
+          file.open (filename, std::ios::binary | std::ios::trunc);
+          if (!file)
+            {
+              throw std::runtime_error ("Failed to open " + filename);
+            }
+        }
+      std::ostream &out     = filename.empty () ? std::cout : file;
+      const auto    puzzles = write_puzzle_bank (out, keywords, dictionary, options);
+      out.flush ();
+      std::cerr << puzzles << " puzzles\n";
+    }
+  catch (const std::exception &e)
+    {
+      std::cerr << e.what () << '\n';
+      return 1;
+    }
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  if (argc > 1 && std::string_view (argv[1]) == "--puzzles")
+    {
+      return puzzle_bank (std::vector<std::string_view> (argv + 2, argv + argc));
+    }
+
   check_properties ();
 
   std::cout << "Warm up\n\n";